@@ -0,0 +1,319 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_BROADPHASE_HPP
+#define SECS_BROADPHASE_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP)
+#define SECS_BROADPHASE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "ComponentHandle.hpp"
+#include "ComponentTracker.hpp"
+#include "World.hpp"
+
+namespace secs
+{
+	/** \struct Aabb
+	 * \brief Axis aligned bounding box used by Broadphase
+	 */
+	struct Aabb
+	{
+		std::array<float, 3> min{};
+		std::array<float, 3> max{};
+	};
+
+	/** \struct BroadphasePair
+	 * \brief Uids of two Entities with overlapping bounding boxes. first is always less than second.
+	 */
+	struct BroadphasePair
+	{
+		Uid first = 0;
+		Uid second = 0;
+
+		[[nodiscard]] constexpr bool operator ==(const BroadphasePair&) const noexcept = default;
+		[[nodiscard]] constexpr auto operator <=>(const BroadphasePair&) const noexcept = default;
+	};
+
+	/** \class Broadphase
+	 * \brief Sweep and prune pair finder for the bounding boxes of Entities
+	 *
+	 * The broadphase keeps the bounding boxes of each running and enabled Entity owning a TComponent sorted along the x axis and reports each pair of
+	 * overlapping boxes during update. Similar to SpatialGrid, membership and box changes are tracked via a ComponentTracker, thus only changed
+	 * Components are read. The sort order is kept between updates, thus re-sorting the nearly sorted boxes of slowly moving Entities is an insertion sort of linear cost.
+	 * The sweep tests four candidates at once on targets supporting SSE2.
+	 *
+	 * Pairs are written into a buffer owned by the broadphase, which keeps its capacity between updates.
+	 * \tparam TComponent Component type holding the bounding box.
+	 * \tparam TProjection Invokable type, which returns the Aabb of a const TComponent&.
+	 */
+	template <Component TComponent, class TProjection = std::identity>
+		requires std::convertible_to<std::invoke_result_t<const TProjection&, const TComponent&>, Aabb>
+	class Broadphase
+	{
+	public:
+		/**
+		 * \brief Constructor
+		 * \throws SystemError if the System of TComponent could not be found.
+		 * \param world The World, whose Entities will be tracked. Must outlive the broadphase.
+		 * \param projection Invokable object, which returns the bounding box of a Component.
+		 */
+		explicit Broadphase(World& world, TProjection projection = TProjection{}) :
+			m_Projection{ std::move(projection) },
+			m_Tracker{ world }
+		{
+			m_Tracker.seed([this](Entity& entity) { insert(entity); });
+		}
+
+		Broadphase(const Broadphase&) = delete;
+		Broadphase& operator =(const Broadphase&) = delete;
+		Broadphase(Broadphase&&) = delete;
+		Broadphase& operator =(Broadphase&&) = delete;
+
+		/**
+		 * \brief Tracked Entity count
+		 * \return Returns the amount of tracked Entities.
+		 */
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return std::size(m_ProxyIndices);
+		}
+
+		/**
+		 * \brief Applies the events collected since the previous call and finds all overlapping pairs
+		 *
+		 * Should be called once per frame after the World's postUpdate. Invalidates the span previously returned by pairs.
+		 */
+		void update()
+		{
+			const auto previousCount = std::size(m_Order);
+			m_Tracker.update(
+							[this](Uid uid) { erase(uid); },
+							[this](Entity& entity) { insert(entity); },
+							[this](Uid uid)
+							{
+								if (auto itr = m_ProxyIndices.find(uid); itr != std::end(m_ProxyIndices))
+								{
+									auto& proxy = m_Proxies[itr->second];
+									if (const auto* component = proxy.handle.get())
+										proxy.box = std::invoke(m_Projection, *component);
+								}
+							}
+							);
+
+			// Inserted proxies are appended and never reuse the proxies released during this update, thus only the previously sorted keys may
+			// refer to released proxies.
+			const auto sortedCount = previousCount - std::erase_if(m_Order, [this](const SortKey& key) { return !m_Proxies[key.proxy].alive; });
+			m_FreeProxies.insert(std::end(m_FreeProxies), std::begin(m_ReleasedProxies), std::end(m_ReleasedProxies));
+			m_ReleasedProxies.clear();
+
+			sort(sortedCount);
+			gatherBoxes();
+			sweep();
+		}
+
+		/**
+		 * \brief Overlapping pairs found during the previous update
+		 * \return Returns a span of pairs in no particular order, which stays valid until the next update.
+		 */
+		[[nodiscard]] std::span<const BroadphasePair> pairs() const noexcept
+		{
+			return m_Pairs;
+		}
+
+	private:
+		struct Proxy
+		{
+			Uid uid = 0;
+			Aabb box;
+			ComponentHandle<const TComponent> handle;
+			bool alive = false;
+		};
+
+		struct SortKey
+		{
+			float min;
+			std::uint32_t proxy;
+		};
+
+		TProjection m_Projection;
+		ComponentTracker<TComponent> m_Tracker;
+		std::vector<Proxy> m_Proxies;
+		std::vector<std::uint32_t> m_FreeProxies;
+		// proxies erased during the current update; they become free after their sort keys have been removed
+		std::vector<std::uint32_t> m_ReleasedProxies;
+		std::unordered_map<Uid, std::uint32_t> m_ProxyIndices;
+		// Proxies sorted by their minimal x coordinate. This order is kept between updates.
+		std::vector<SortKey> m_Order;
+		// The boxes in sweep order as structure of arrays, thus multiple candidates can be loaded at once.
+		std::array<std::vector<float>, 3> m_Mins;
+		std::array<std::vector<float>, 3> m_Maxs;
+		std::vector<Uid> m_Uids;
+		std::vector<BroadphasePair> m_Pairs;
+
+		void insert(Entity& entity)
+		{
+			auto handle = entity.componentHandle<const TComponent>();
+			if (!handle || m_ProxyIndices.contains(entity.uid()))
+				return;
+
+			std::uint32_t index = 0;
+			if (std::empty(m_FreeProxies))
+			{
+				index = static_cast<std::uint32_t>(std::size(m_Proxies));
+				m_Proxies.emplace_back();
+			}
+			else
+			{
+				index = m_FreeProxies.back();
+				m_FreeProxies.pop_back();
+			}
+
+			auto& proxy = m_Proxies[index];
+			proxy = { entity.uid(), std::invoke(m_Projection, *handle), handle, true };
+			m_ProxyIndices.emplace(entity.uid(), index);
+			m_Order.push_back({ proxy.box.min[0], index });
+		}
+
+		void erase(Uid uid)
+		{
+			if (auto itr = m_ProxyIndices.find(uid); itr != std::end(m_ProxyIndices))
+			{
+				m_Proxies[itr->second] = {};
+				m_ReleasedProxies.emplace_back(itr->second);
+				m_ProxyIndices.erase(itr);
+			}
+		}
+
+		// The first sortedCount keys have been sorted during the previous update, thus only moved proxies are out of place.
+		void sort(std::size_t sortedCount)
+		{
+			for (auto& key : m_Order)
+				key.min = m_Proxies[key.proxy].box.min[0];
+
+			const auto sortedEnd = std::begin(m_Order) + static_cast<std::ptrdiff_t>(sortedCount);
+			for (auto itr = std::begin(m_Order); itr != sortedEnd; ++itr)
+			{
+				const auto key = *itr;
+				auto hole = itr;
+				for (; hole != std::begin(m_Order) && key.min < std::prev(hole)->min; --hole)
+					*hole = *std::prev(hole);
+				*hole = key;
+			}
+
+			// newly inserted proxies are in no particular order
+			std::ranges::sort(sortedEnd, std::end(m_Order), std::less{}, &SortKey::min);
+			std::ranges::inplace_merge(m_Order, sortedEnd, std::less{}, &SortKey::min);
+		}
+
+		void gatherBoxes()
+		{
+			const auto count = std::size(m_Order);
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				m_Mins[axis].resize(count);
+				m_Maxs[axis].resize(count);
+			}
+			m_Uids.resize(count);
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const auto& proxy = m_Proxies[m_Order[i].proxy];
+				for (std::size_t axis = 0; axis < 3; ++axis)
+				{
+					m_Mins[axis][i] = proxy.box.min[axis];
+					m_Maxs[axis][i] = proxy.box.max[axis];
+				}
+				m_Uids[i] = proxy.uid;
+			}
+		}
+
+		void sweep()
+		{
+			m_Pairs.clear();
+			const auto count = std::size(m_Uids);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				auto candidate = i + 1u;
+#ifdef SECS_BROADPHASE_SSE2
+				candidate = sweepPacked(i, candidate);
+#endif
+				// candidates are sorted, thus the first one starting behind the current box ends the sweep
+				for (; candidate < count && m_Mins[0][candidate] <= m_Maxs[0][i]; ++candidate)
+				{
+					if (overlapsYZ(i, candidate))
+						addPair(i, candidate);
+				}
+			}
+		}
+
+#ifdef SECS_BROADPHASE_SSE2
+		// Tests four candidates at once and returns the first candidate, which has not been tested yet. Returns a candidate beyond the sweep range,
+		// if the range ended within the tested candidates.
+		[[nodiscard]] std::size_t sweepPacked(std::size_t i, std::size_t candidate)
+		{
+			const auto count = std::size(m_Uids);
+			const auto maxX = _mm_set1_ps(m_Maxs[0][i]);
+			const auto minY = _mm_set1_ps(m_Mins[1][i]);
+			const auto maxY = _mm_set1_ps(m_Maxs[1][i]);
+			const auto minZ = _mm_set1_ps(m_Mins[2][i]);
+			const auto maxZ = _mm_set1_ps(m_Maxs[2][i]);
+			for (; candidate + 4u <= count; candidate += 4u)
+			{
+				const auto inRange = _mm_cmple_ps(_mm_loadu_ps(&m_Mins[0][candidate]), maxX);
+				const auto overlapsY = _mm_and_ps(
+												_mm_cmple_ps(_mm_loadu_ps(&m_Mins[1][candidate]), maxY),
+												_mm_cmple_ps(minY, _mm_loadu_ps(&m_Maxs[1][candidate]))
+											);
+				const auto overlapsZ = _mm_and_ps(
+												_mm_cmple_ps(_mm_loadu_ps(&m_Mins[2][candidate]), maxZ),
+												_mm_cmple_ps(minZ, _mm_loadu_ps(&m_Maxs[2][candidate]))
+											);
+				const auto rangeMask = _mm_movemask_ps(inRange);
+				auto hitMask = _mm_movemask_ps(_mm_and_ps(inRange, _mm_and_ps(overlapsY, overlapsZ)));
+				for (std::size_t lane = 0; hitMask != 0; ++lane, hitMask >>= 1)
+				{
+					if (hitMask & 1)
+						addPair(i, candidate + lane);
+				}
+
+				if (rangeMask != 0b1111)
+					return count;
+			}
+			return candidate;
+		}
+#endif
+
+		[[nodiscard]] bool overlapsYZ(std::size_t lhs, std::size_t rhs) const noexcept
+		{
+			return m_Mins[1][rhs] <= m_Maxs[1][lhs] && m_Mins[1][lhs] <= m_Maxs[1][rhs] &&
+					m_Mins[2][rhs] <= m_Maxs[2][lhs] && m_Mins[2][lhs] <= m_Maxs[2][rhs];
+		}
+
+		void addPair(std::size_t lhs, std::size_t rhs)
+		{
+			const auto [first, second] = std::minmax(m_Uids[lhs], m_Uids[rhs]);
+			m_Pairs.push_back({ first, second });
+		}
+	};
+}
+
+#endif
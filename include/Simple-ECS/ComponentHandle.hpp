@@ -0,0 +1,150 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_COMPONENT_HANDLE_HPP
+#define SECS_COMPONENT_HANDLE_HPP
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "Concepts.hpp"
+#include "Defines.hpp"
+#include "System.hpp"
+
+namespace secs
+{
+	/** \class ComponentHandle
+	 * \brief Typed reference to a Component object, which detects the destruction of its target
+	 *
+	 * Handles are obtained via Entity::componentHandle or SystemBase::componentHandle and store the concrete System, the slot uid and the activation
+	 * generation of the Component. Accessing the Component is a typed load from the System's storage without any type lookup or rtti call. As soon as
+	 * the Component gets destroyed or its Entity gets recycled, the handle becomes invalid, even if the slot is reused by another Component.
+	 *
+	 * Handles of const qualified Component types only grant read access and do not report the Component as changed. Handles must not be used concurrently
+	 * to the creation or destruction of Components of the same type, similar to SystemBase::findComponent.
+	 * \tparam T Component type, which may be const qualified.
+	 */
+	template <class T>
+		requires Component<std::remove_const_t<T>>
+	class ComponentHandle
+	{
+		using ComponentType = std::remove_const_t<T>;
+		using System_t = std::conditional_t<std::is_const_v<T>, const SystemBase<ComponentType>, SystemBase<ComponentType>>;
+
+		template <class TComponent>
+		friend class SystemBase;
+
+		template <class TOther>
+			requires Component<std::remove_const_t<TOther>>
+		friend class ComponentHandle;
+
+	public:
+		/**
+		 * \brief Default Constructor
+		 *
+		 * Constructs an invalid handle.
+		 */
+		constexpr ComponentHandle() noexcept = default;
+
+		/**
+		 * \brief Converting constructor from a mutable handle
+		 * \param other The handle to be converted.
+		 */
+		template <std::same_as<ComponentType> TOther>
+			requires std::is_const_v<T>
+		constexpr ComponentHandle(const ComponentHandle<TOther>& other) noexcept :
+			m_System{ other.m_System },
+			m_Uid{ other.m_Uid },
+			m_Generation{ other.m_Generation }
+		{
+		}
+
+		/**
+		 * \brief Queries the Component object
+		 *
+		 * For non-const Component types this counts as mutable access, thus the Component will be reported as changed.
+		 * \return Returns a pointer to the Component object or nullptr if it has been destroyed.
+		 */
+		[[nodiscard]] T* get() const noexcept
+		{
+			return m_System ? m_System->findComponent(m_Uid, m_Generation) : nullptr;
+		}
+
+		/**
+		 * \brief Checks if the Component object is still alive
+		 * \return True if the Component has not been destroyed.
+		 */
+		[[nodiscard]] bool isValid() const noexcept
+		{
+			return m_System && std::as_const(*m_System).findComponent(m_Uid, m_Generation);
+		}
+
+		/**
+		 * \brief Checks if the Component object is still alive
+		 * \return True if the Component has not been destroyed.
+		 */
+		[[nodiscard]] explicit operator bool() const noexcept
+		{
+			return isValid();
+		}
+
+		/**
+		 * \brief Dereferences the Component object
+		 * \remark The behaviour is undefined if the handle is not valid.
+		 * \return Reference to the Component object.
+		 */
+		[[nodiscard]] T& operator *() const noexcept
+		{
+			auto* component = get();
+			assert(component);
+			return *component;
+		}
+
+		/**
+		 * \brief Dereferences the Component object
+		 * \remark The behaviour is undefined if the handle is not valid.
+		 * \return Pointer to the Component object.
+		 */
+		[[nodiscard]] T* operator ->() const noexcept
+		{
+			auto* component = get();
+			assert(component);
+			return component;
+		}
+
+		/**
+		 * \brief Uid of the Component slot
+		 * \return Returns the uid, which was valid during the creation of this handle.
+		 */
+		[[nodiscard]] constexpr Uid uid() const noexcept
+		{
+			return m_Uid;
+		}
+
+		/**
+		 * \brief Equality comparison
+		 * \return True if both handles refer to the same Component object.
+		 */
+		[[nodiscard]] constexpr bool operator ==(const ComponentHandle&) const noexcept = default;
+
+	private:
+		System_t* m_System = nullptr;
+		Uid m_Uid = 0;
+		std::uint64_t m_Generation = 0;
+
+		constexpr ComponentHandle(System_t& system, Uid uid, std::uint64_t generation) noexcept :
+			m_System{ &system },
+			m_Uid{ uid },
+			m_Generation{ generation }
+		{
+		}
+	};
+}
+
+#endif
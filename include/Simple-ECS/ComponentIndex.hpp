@@ -0,0 +1,247 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_COMPONENT_INDEX_HPP
+#define SECS_COMPONENT_INDEX_HPP
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Concepts.hpp"
+#include "Defines.hpp"
+#include "Entity.hpp"
+#include "Query.hpp"
+#include "System.hpp"
+
+namespace secs
+{
+	/** \enum IndexKind
+	 * \brief Lookup structures a ComponentIndex may use
+	 */
+	enum class IndexKind
+	{
+		hash,
+		ordered
+	};
+
+	/** \var IndexKind IndexKind::hash
+	 * \brief Hashed keys, which offer lookups of constant complexity. Keys must be hashable.
+	 */
+
+	/** \var IndexKind IndexKind::ordered
+	 * \brief Sorted keys, which offer lookups of logarithmic complexity and range queries. Keys must be less than comparable.
+	 */
+}
+
+namespace secs::detail
+{
+	template <auto VMember>
+	struct MemberPointerTraits;
+
+	template <class TClass, class TMember, TMember TClass::* VMember>
+	struct MemberPointerTraits<VMember>
+	{
+		using ClassType = TClass;
+		using MemberType = TMember;
+	};
+}
+
+namespace secs
+{
+	/** \class ComponentIndex
+	 * \brief Secondary index, which maps the value of a Component field to the Entities owning such a Component
+	 *
+	 * Indices are registered via World::index and are maintained by the World at the same occasions as Queries, thus disabled Entities are not part
+	 * of any index. Additionally, the keys of Components, which have been changed since the previous postUpdate, are refreshed via the change
+	 * tracking of the System, thus only Components which have been accessed mutably are reconsidered.
+	 *
+	 * Keys are refreshed during postUpdate, thus changes become visible to lookups after the next postUpdate. Lookups may be issued concurrently,
+	 * but not concurrently to postUpdate.
+	 * \tparam VMember Pointer to the indexed data member of a Component type.
+	 * \tparam VKind The lookup structure.
+	 */
+	template <auto VMember, IndexKind VKind = IndexKind::hash>
+		requires std::is_member_object_pointer_v<decltype(VMember)>
+	class ComponentIndex final :
+		public detail::QueryBase
+	{
+	public:
+		/** \typedef ComponentType
+		 * \brief Indexed Component type
+		 */
+		using ComponentType = typename detail::MemberPointerTraits<VMember>::ClassType;
+
+		/** \typedef KeyType
+		 * \brief Type of the indexed field
+		 */
+		using KeyType = typename detail::MemberPointerTraits<VMember>::MemberType;
+
+		/**
+		 * \brief Constructor
+		 * \param system The System of the indexed Component type.
+		 */
+		explicit ComponentIndex(SystemBase<ComponentType>& system) noexcept :
+			m_System{ &system },
+			// Components may still be stamped with the current version after their keys have been read, thus those have to be checked again.
+			m_ChangeVersion{ system.changeVersion() - 1u }
+		{
+		}
+
+		/**
+		 * \brief Counts indexed Entities
+		 * \return Amount of indexed Entities.
+		 */
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return std::size(m_Locations);
+		}
+
+		/**
+		 * \brief Empty
+		 * \return True if no Entity is indexed.
+		 */
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return std::empty(m_Locations);
+		}
+
+		/**
+		 * \brief Looks up the Entities with a specific key
+		 * \param key The key to look for.
+		 * \return Returns a span over pointers to each Entity, whose indexed field equals key, in no particular order. The span stays valid until the
+		 * next postUpdate.
+		 */
+		[[nodiscard]] std::span<Entity* const> find(const KeyType& key) const
+		{
+			if (auto itr = m_Buckets.find(key); itr != std::end(m_Buckets))
+				return itr->second;
+			return {};
+		}
+
+		/**
+		 * \brief Counts the Entities with a specific key
+		 * \param key The key to look for.
+		 * \return Amount of Entities, whose indexed field equals key.
+		 */
+		[[nodiscard]] std::size_t count(const KeyType& key) const
+		{
+			return std::size(find(key));
+		}
+
+		/**
+		 * \brief Executes action on each Entity whose key lies within a range
+		 *
+		 * Only available for ordered indices. Entities are visited in ascending order of their keys.
+		 * \tparam TAction Invokable object with specific signature.
+		 * \param min The smallest key to be visited.
+		 * \param max The greatest key to be visited.
+		 * \param action Invokable object, which receives each Entity and its key.
+		 */
+		template <std::invocable<Entity&, const KeyType&> TAction>
+			requires (VKind == IndexKind::ordered)
+		void forEachInRange(const KeyType& min, const KeyType& max, TAction action) const
+		{
+			for (auto itr = m_Buckets.lower_bound(min); itr != std::end(m_Buckets) && !(max < itr->first); ++itr)
+			{
+				for (auto* entity : itr->second)
+					action(*entity, itr->first);
+			}
+		}
+
+	private:
+		using Container = std::conditional_t<
+			VKind == IndexKind::hash,
+			std::unordered_map<KeyType, std::vector<Entity*>>,
+			std::map<KeyType, std::vector<Entity*>>
+		>;
+
+		struct Location
+		{
+			KeyType key;
+			// position inside the bucket
+			std::size_t slot;
+		};
+
+		SystemBase<ComponentType>* m_System;
+		std::uint64_t m_ChangeVersion;
+		// Buckets are removed as soon as they become empty, thus ordered range queries never visit empty keys.
+		Container m_Buckets;
+		std::unordered_map<Uid, Location> m_Locations;
+
+		void insert(Entity& entity) override
+		{
+			if (m_Locations.contains(entity.uid()))
+				return;
+
+			if (const auto* component = std::as_const(entity).findComponent<ComponentType>())
+				add(entity, component->*VMember);
+		}
+
+		void erase(const Entity& entity) noexcept override
+		{
+			if (auto itr = m_Locations.find(entity.uid()); itr != std::end(m_Locations))
+			{
+				remove(itr->second);
+				m_Locations.erase(itr);
+			}
+		}
+
+		void collectChanges() override
+		{
+			m_ChangeVersion = std::as_const(*m_System).forEachChangedComponent(
+																				m_ChangeVersion,
+																				[this](Entity& entity, const ComponentType& component)
+																				{
+																					rekey(entity, component.*VMember);
+																				}
+																			);
+		}
+
+		void rekey(Entity& entity, const KeyType& key)
+		{
+			// Entities which are not indexed yet will be inserted with their current key.
+			const auto itr = m_Locations.find(entity.uid());
+			if (itr == std::end(m_Locations) || itr->second.key == key)
+				return;
+
+			remove(itr->second);
+			m_Locations.erase(itr);
+			add(entity, key);
+		}
+
+		void add(Entity& entity, const KeyType& key)
+		{
+			auto& bucket = m_Buckets[key];
+			bucket.emplace_back(&entity);
+			m_Locations.emplace(entity.uid(), Location{ key, std::size(bucket) - 1u });
+		}
+
+		void remove(const Location& location) noexcept
+		{
+			const auto bucketItr = m_Buckets.find(location.key);
+			auto& bucket = bucketItr->second;
+			if (location.slot + 1u != std::size(bucket))
+			{
+				bucket[location.slot] = bucket.back();
+				m_Locations.find(bucket[location.slot]->uid())->second.slot = location.slot;
+			}
+			bucket.pop_back();
+
+			if (std::empty(bucket))
+				m_Buckets.erase(bucketItr);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,138 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_COMPONENT_TRACKER_HPP
+#define SECS_COMPONENT_TRACKER_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <iterator>
+#include <vector>
+
+#include "Entity.hpp"
+#include "Observer.hpp"
+#include "System.hpp"
+#include "World.hpp"
+
+namespace secs
+{
+	/** \class ComponentTracker
+	 * \brief Tracks the running and enabled Entities owning a TComponent via Observers of the World
+	 *
+	 * This is the common building block of structures, which maintain an external copy of Component data incrementally, like SpatialGrid or
+	 * Broadphase. The tracker owns an Added, a Removed and a Changed Observer and translates their events into insert, erase and change calls. As
+	 * Entities may have been disabled and enabled again since the previous update, membership events are resolved by the current state of the
+	 * Entity.
+	 * \tparam TComponent The tracked Component type.
+	 */
+	template <Component TComponent>
+	class ComponentTracker
+	{
+	public:
+		/**
+		 * \brief Constructor
+		 * \throws SystemError if the System of TComponent could not be found.
+		 * \param world The World, whose Entities will be tracked. Must outlive the tracker.
+		 */
+		explicit ComponentTracker(World& world) :
+			m_World{ world },
+			m_System{ &world.systemByComponentType<TComponent>() },
+			m_AddedObserver{ &world.observe<Added<TComponent>>() },
+			m_RemovedObserver{ &world.observe<Removed<TComponent>>() },
+			m_ChangedObserver{ &world.observe<Changed<TComponent>>() }
+		{
+		}
+
+		ComponentTracker(const ComponentTracker&) = delete;
+		ComponentTracker& operator =(const ComponentTracker&) = delete;
+		ComponentTracker(ComponentTracker&&) = delete;
+		ComponentTracker& operator =(ComponentTracker&&) = delete;
+
+		/**
+		 * \brief Destructor
+		 *
+		 * Removes the Observers from the World.
+		 */
+		~ComponentTracker() noexcept
+		{
+			m_World.removeObserver(*m_AddedObserver);
+			m_World.removeObserver(*m_RemovedObserver);
+			m_World.removeObserver(*m_ChangedObserver);
+		}
+
+		/**
+		 * \brief Checks whether an Entity should be tracked
+		 * \param entity The Entity to check.
+		 * \return Returns true if the Entity is running and enabled.
+		 */
+		[[nodiscard]] static bool isTracked(const Entity& entity) noexcept
+		{
+			return entity.state() == EntityState::running && entity.isEnabled();
+		}
+
+		/**
+		 * \brief Executes insert on each Entity, which is already tracked
+		 *
+		 * Should be called once during construction of the owner, as the Observers only report events which happen afterwards.
+		 * \tparam TInsert Invokable object with specific signature.
+		 * \param insert Invokable object, which receives each tracked Entity.
+		 */
+		template <std::invocable<Entity&> TInsert>
+		void seed(TInsert insert) const
+		{
+			for (auto& entity : m_System->entities())
+			{
+				if (isTracked(entity))
+					insert(entity);
+			}
+		}
+
+		/**
+		 * \brief Applies the events collected since the previous call
+		 *
+		 * Each Entity with a membership event is erased first; all erasures happen before the first insertion. Entities which are still tracked
+		 * are inserted afterwards, thus re-inserted Entities are treated as new ones. Finally, change is executed on each Entity, whose TComponent
+		 * has been changed; those may not be tracked by the owner.
+		 * \tparam TErase Invokable object with specific signature.
+		 * \tparam TInsert Invokable object with specific signature.
+		 * \tparam TChange Invokable object with specific signature.
+		 * \param erase Invokable object, which receives the uid of each Entity with a membership event.
+		 * \param insert Invokable object, which receives each tracked Entity with a membership event.
+		 * \param change Invokable object, which receives the uid of each Entity with a changed TComponent.
+		 */
+		template <std::invocable<Uid> TErase, std::invocable<Entity&> TInsert, std::invocable<Uid> TChange>
+		void update(TErase erase, TInsert insert, TChange change)
+		{
+			const auto added = m_AddedObserver->drain();
+			const auto removed = m_RemovedObserver->drain();
+			m_MembershipChanges.clear();
+			std::ranges::set_union(added, removed, std::back_inserter(m_MembershipChanges));
+
+			for (auto uid : m_MembershipChanges)
+				erase(uid);
+
+			for (auto uid : m_MembershipChanges)
+			{
+				if (auto* entity = m_World.findEntity(uid); entity && isTracked(*entity))
+					insert(*entity);
+			}
+
+			for (auto uid : m_ChangedObserver->drain())
+				change(uid);
+		}
+
+	private:
+		World& m_World;
+		SystemBase<TComponent>* m_System;
+		Observer* m_AddedObserver;
+		Observer* m_RemovedObserver;
+		Observer* m_ChangedObserver;
+		std::vector<Uid> m_MembershipChanges;
+	};
+}
+
+#endif
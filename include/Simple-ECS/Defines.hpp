@@ -17,6 +17,16 @@ namespace secs
 	 */
 	using Uid = std::size_t;
 
+	/** \struct TypeList
+	 * \brief Compile time list of types.
+	 *
+	 * Systems use this to declare their ReadAccess and WriteAccess.
+	 */
+	template <class... T>
+	struct TypeList
+	{
+	};
+
 	/** \enum EntityState
 	 * \brief States an Entity may have.
 	 *
@@ -0,0 +1,129 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_DOUBLE_BUFFERED_HPP
+#define SECS_DOUBLE_BUFFERED_HPP
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+namespace secs
+{
+	/** \class DoubleBuffered
+	 * \brief Component storage policy which separates the state of the previous frame from the state of the next frame
+	 *
+	 * Use DoubleBuffered<T> as Component type of a System to opt in. Systems read the state of the previous frame via previous() and write
+	 * the state of the next frame via next(). The World commits each active DoubleBuffered Component as the last step of postUpdate,
+	 * after Entities have changed their states, thus previous() never changes during a frame and Components of Entities created during a frame
+	 * are committed before their first update. Systems which only read previous() therefore never conflict with Systems writing next(), which
+	 * should be expressed via the access tags Previous<T> and Next<T> in their ReadAccess and WriteAccess declarations. The results do not
+	 * depend on the order in which such Systems are executed, thus they are deterministic regardless of the amount of worker threads.
+	 *
+	 * Committing copies the next state into the previous state, thus next() keeps the most recent state and may be written partially.
+	 * \tparam T Value type.
+	 */
+	template <class T>
+	class DoubleBuffered
+	{
+	public:
+		/**
+		 * \brief Alias for the value type.
+		 */
+		using ValueType = T;
+
+		/**
+		 * \brief Default Constructor
+		 *
+		 * Value initializes both states.
+		 */
+		DoubleBuffered() = default;
+
+		/**
+		 * \brief Constructor
+		 * \param value Initial value of both states.
+		 */
+		explicit DoubleBuffered(const T& value) :
+			m_Previous{ value },
+			m_Next{ value }
+		{
+		}
+
+		/**
+		 * \brief State of the previous frame
+		 * \return Const reference to the committed state.
+		 */
+		[[nodiscard]] const T& previous() const noexcept
+		{
+			return m_Previous;
+		}
+
+		/**
+		 * \brief State of the next frame
+		 * \return Const reference to the uncommitted state.
+		 */
+		[[nodiscard]] const T& next() const noexcept
+		{
+			return m_Next;
+		}
+
+		/**
+		 * \brief State of the next frame
+		 * \return Reference to the uncommitted state.
+		 */
+		[[nodiscard]] T& next() noexcept
+		{
+			return m_Next;
+		}
+
+		/**
+		 * \brief Commits the next state
+		 *
+		 * This is done by the World at the end of each postUpdate, thus users usually do not have to call it.
+		 */
+		void commit() noexcept(std::is_nothrow_copy_assignable_v<T>)
+		{
+			m_Previous = m_Next;
+		}
+
+	private:
+		T m_Previous{};
+		T m_Next{};
+	};
+
+	/** \struct Previous
+	 * \brief Access tag for reading the previous state of DoubleBuffered<T> Components
+	 */
+	template <class T>
+	struct Previous
+	{
+	};
+
+	/** \struct Next
+	 * \brief Access tag for writing the next state of DoubleBuffered<T> Components
+	 */
+	template <class T>
+	struct Next
+	{
+	};
+}
+
+namespace secs::detail
+{
+	template <class T>
+	struct IsDoubleBuffered :
+		std::false_type
+	{
+	};
+
+	template <class T>
+	struct IsDoubleBuffered<DoubleBuffered<T>> :
+		std::true_type
+	{
+	};
+}
+
+#endif
@@ -8,13 +8,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <memory>
+#include <mutex>
 #include <ranges>
 #include <stdexcept>
 #include <typeindex>
+#include <utility>
 #include <vector>
 
+#include "ComponentHandle.hpp"
 #include "Concepts.hpp"
 #include "Defines.hpp"
 #include "System.hpp"
@@ -24,6 +29,18 @@ namespace secs
 	class Entity;
 }
 
+namespace secs::detail
+{
+	struct EntityPool;
+
+	// Uids of Entities whose enabled state has been toggled since the previous postUpdate
+	struct EnableRequestQueue
+	{
+		std::mutex mx;
+		std::vector<Uid> uids;
+	};
+}
+
 namespace secs
 {
 	class EntityError final :
@@ -52,6 +69,12 @@ namespace secs
 	class Entity
 	{
 		friend class World;
+		template <class, class>
+		friend class View;
+		template <class, class>
+		friend class Query;
+		template <class>
+		friend class Group;
 
 	public:
 		Entity(const Entity&) = delete;
@@ -79,8 +102,8 @@ namespace secs
 		{
 			for (auto& info : m_ComponentInfos)
 			{
-				assert(info.rtti && info.systemPtr && info.componentUid != 0);
-				info.rtti->destroy(info.systemPtr, info.componentUid);
+				assert(info.rtti && info.system && info.componentUid != 0);
+				info.rtti->destroy(*info.system, info.componentUid);
 			}
 		}
 
@@ -95,11 +118,38 @@ namespace secs
 
 		/**
 		 * \brief Current state
+		 * \remark This function is thread-safe.
 		 * \return Returns the current \ref EntityState of this Entity.
 		 */
-		[[nodiscard]] constexpr EntityState state() const noexcept
+		[[nodiscard]] EntityState state() const noexcept
 		{
-			return m_State;
+			return m_State.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * \brief Enables or disables this Entity
+		 *
+		 * The Components of disabled Entities stay alive in their slots, but are skipped by their Systems' iterations. The change takes effect during
+		 * the World's next postUpdate, thus Systems which are currently iterating are not disturbed. Entities are enabled by default.
+		 * \remark This function is thread-safe.
+		 * \param enabled False to disable this Entity.
+		 */
+		void setEnabled(bool enabled)
+		{
+			if (m_Enabled.exchange(enabled, std::memory_order_relaxed) != enabled && m_EnableRequests)
+			{
+				std::scoped_lock lock{ m_EnableRequests->mx };
+				m_EnableRequests->uids.emplace_back(m_Uid);
+			}
+		}
+
+		/**
+		 * \brief Checks if this Entity is enabled
+		 * \return Returns the state most recently passed to setEnabled, even if it has not taken effect yet.
+		 */
+		[[nodiscard]] bool isEnabled() const noexcept
+		{
+			return m_Enabled.load(std::memory_order_relaxed);
 		}
 
 		/**
@@ -129,7 +179,7 @@ namespace secs
 			if (auto itr = findComponentInfo<TComponent>(m_ComponentInfos); itr != std::end(m_ComponentInfos))
 			{
 				assert(isValid(*itr));
-				return static_cast<const TComponent*>(itr->rtti->findComponent(itr->systemPtr, itr->componentUid));
+				return static_cast<const TComponent*>(itr->rtti->findComponent(*itr->system, itr->componentUid));
 			}
 			return nullptr;
 		}
@@ -137,7 +187,9 @@ namespace secs
 		/**
 		 * \brief Queries for a specific Component type
 		 *
-		 * This function searches for a specific Component type and returns a pointer to the caller.
+		 * This function searches for a specific Component type and returns a pointer to the caller. Modifications via the returned pointer are
+		 * not reported as changes, because the Entity may be accessed by Systems which only declared read access to the Component type. Use
+		 * componentHandle or the accessors of the owning System for tracked modifications.
 		  * \remark This function does not perform any inheritance checks, thus you can always query for concrete Component types.
 		 * \tparam TComponent Expected Component type.
 		 * \return Pointer to the stored Component object or nullptr if not found.
@@ -171,7 +223,8 @@ namespace secs
 		/**
 		 * \brief Queries for a specific Component type
 		 *
-		 * This function searches for a specific Component type and returns a reference to the caller.
+		 * This function searches for a specific Component type and returns a reference to the caller. Similar to findComponent, modifications
+		 * are not reported as changes.
 		 * \remark This function does not perform any inheritance checks, thus you can always query for concrete Component types.
 		 * \tparam TComponent Expected Component type.
 		 * \throws EntityError if a Component object could not be found.
@@ -188,10 +241,51 @@ namespace secs
 			throw EntityError("Component not found: "s + typeid(TComponent).name());
 		}
 
+		/**
+		 * \brief Creates a handle for a specific Component type
+		 *
+		 * The returned handle grants direct access to the Component, which is much cheaper than repeated findComponent calls. See \ref ComponentHandle
+		 * for details.
+		 * \remark This function does not perform any inheritance checks, thus you can always query for concrete Component types.
+		 * \tparam TComponent Expected Component type. If const qualified, the handle will only grant read access.
+		 * \return Returns a handle to the Component object or an invalid handle if not found.
+		 */
+		template <class TComponent>
+			requires Component<std::remove_const_t<TComponent>>
+		[[nodiscard]] ComponentHandle<TComponent> componentHandle() noexcept
+		{
+			using ComponentType = std::remove_const_t<TComponent>;
+			if (auto itr = findComponentInfo<ComponentType>(m_ComponentInfos); itr != std::end(m_ComponentInfos))
+			{
+				assert(isValid(*itr));
+				return static_cast<SystemBase<ComponentType>&>(*itr->system).componentHandle(itr->componentUid);
+			}
+			return {};
+		}
+
+		/**
+		 * \brief Creates a read only handle for a specific Component type
+		 *
+		 * See the non-const overload for details.
+		 * \tparam TComponent Expected Component type, which must be const qualified.
+		 * \return Returns a handle to the Component object or an invalid handle if not found.
+		 */
+		template <class TComponent>
+			requires std::is_const_v<TComponent> && Component<std::remove_const_t<TComponent>>
+		[[nodiscard]] ComponentHandle<TComponent> componentHandle() const noexcept
+		{
+			return const_cast<Entity&>(*this).componentHandle<TComponent>();
+		}
+
 	private:
 		Uid m_Uid = 0;
-		EntityState m_State = EntityState::none;
+		std::atomic<EntityState> m_State{ EntityState::none };
 		std::vector<detail::ComponentStorageInfo> m_ComponentInfos;
+		// Pool this Entity returns to after its destruction; nullptr if recycling is not enabled for its signature
+		detail::EntityPool* m_Pool = nullptr;
+		std::atomic<bool> m_Enabled{ true };
+		// assigned by the World
+		detail::EnableRequestQueue* m_EnableRequests = nullptr;
 
 		template <class TComponent, class TContainer>
 		static auto findComponentInfo(TContainer& container)
@@ -200,16 +294,32 @@ namespace secs
 			return std::ranges::find(container, expectedTypeIndex, [](const detail::ComponentStorageInfo& info) { return info.componentTypeIndex; });
 		}
 
+		// Systems will not be notified directly; the World flushes the gathered state changes for each System at once.
 		void changeState(EntityState state)
 		{
-			assert(static_cast<int>(m_State) < static_cast<int>(state));
-			m_State = state;
+			assert(static_cast<int>(this->state()) < static_cast<int>(state));
+			m_State.store(state, std::memory_order_relaxed);
+
+			for (auto& info : m_ComponentInfos)
+			{
+				assert(isValid(info));
+				if (info.observesEntityStates)
+					info.system->m_PendingStateChanges.emplace_back(info.componentUid);
+			}
+		}
 
+		// Moves the Components into or out of the enabled partition of their Systems. Returns false, if the Entity already was in the requested
+		// state, e.g. because it has been toggled multiple times.
+		bool applyEnabled() noexcept
+		{
+			const auto enabled = isEnabled();
+			bool changed = false;
 			for (auto& info : m_ComponentInfos)
 			{
 				assert(isValid(info));
-				info.rtti->entityStateChanged(info.systemPtr, info.componentUid);
+				changed = info.rtti->setEnabled(*info.system, info.componentUid, enabled) || changed;
 			}
+			return changed;
 		}
 
 		void setComponentEntity() noexcept
@@ -217,7 +327,7 @@ namespace secs
 			for (auto& info : m_ComponentInfos)
 			{
 				assert(isValid(info));
-				info.rtti->setEntity(info.systemPtr, info.componentUid, *this);
+				info.rtti->setEntity(*info.system, info.componentUid, *this);
 			}
 		}
 	};
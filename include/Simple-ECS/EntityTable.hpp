@@ -0,0 +1,167 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_ENTITY_TABLE_HPP
+#define SECS_ENTITY_TABLE_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Defines.hpp"
+
+namespace secs
+{
+	class Entity;
+}
+
+namespace secs::detail
+{
+	/**
+	 * \brief Uid indexed lookup table for Entities with a lock-free read path
+	 *
+	 * Entity uids are handed out in increasing order and are never reused, thus they are directly used as index into
+	 * fixed size pages of atomic Entity pointers. The pages are referenced by a directory, which is republished as a whole
+	 * when it has to grow. Readers never block; they simply follow the currently published directory and page.
+	 *
+	 * Pages of which each uid has already been erased and outdated directories are not freed immediately, but retired instead. Retired
+	 * memory will be released during the second collectGarbage call after its retirement, thus readers which started before
+	 * the retirement have at least one full World update cycle to finish their lookup.
+	 * \remark insert may be called from multiple threads, but erase and collectGarbage must be called from one thread only.
+	 */
+	class EntityTable
+	{
+	public:
+		static constexpr std::size_t pageSize = 4096;
+
+		EntityTable() :
+			m_Directory{ new Directory(0) }
+		{
+		}
+
+		EntityTable(const EntityTable&) = delete;
+		EntityTable& operator =(const EntityTable&) = delete;
+		EntityTable(EntityTable&&) = delete;
+		EntityTable& operator =(EntityTable&&) = delete;
+
+		~EntityTable() noexcept
+		{
+			std::unique_ptr<Directory> directory{ m_Directory.load() };
+			for (auto& page : directory->pages)
+				delete page.load();
+		}
+
+		[[nodiscard]] Entity* find(Uid uid) const noexcept
+		{
+			const auto* directory = m_Directory.load(std::memory_order_acquire);
+			if (const auto pageIndex = uid / pageSize; pageIndex < std::size(directory->pages))
+			{
+				if (const auto* page = directory->pages[pageIndex].load(std::memory_order_acquire))
+					return page->slots[uid % pageSize].load(std::memory_order_acquire);
+			}
+			return nullptr;
+		}
+
+		void insert(Uid uid, Entity& entity)
+		{
+			assert(uid != 0);
+			const auto pageIndex = uid / pageSize;
+			auto* page = findPage(pageIndex);
+			if (!page)
+				page = makePage(pageIndex);
+
+			assert(page->slots[uid % pageSize].load(std::memory_order_relaxed) == nullptr);
+			page->slots[uid % pageSize].store(&entity, std::memory_order_release);
+		}
+
+		void erase(Uid uid) noexcept
+		{
+			const auto pageIndex = uid / pageSize;
+			auto* page = findPage(pageIndex);
+			assert(page && page->slots[uid % pageSize].load(std::memory_order_relaxed) != nullptr);
+
+			page->slots[uid % pageSize].store(nullptr, std::memory_order_release);
+			if (++page->erasedCount == pageSize)
+			{
+				std::scoped_lock lock{ m_WriteMx };
+				m_Directory.load(std::memory_order_relaxed)->pages[pageIndex].store(nullptr, std::memory_order_release);
+				m_RetiredPages.emplace_back(page);
+			}
+		}
+
+		void collectGarbage() noexcept
+		{
+			std::scoped_lock lock{ m_WriteMx };
+			m_CollectablePages = std::exchange(m_RetiredPages, {});
+			m_CollectableDirectories = std::exchange(m_RetiredDirectories, {});
+		}
+
+	private:
+		struct Page
+		{
+			std::array<std::atomic<Entity*>, pageSize> slots{};
+			// Only touched by the erasing thread. Uid 0 is never used, thus it will be treated as already erased.
+			std::size_t erasedCount = 0;
+		};
+
+		struct Directory
+		{
+			explicit Directory(std::size_t size) :
+				pages(size)
+			{
+			}
+
+			std::vector<std::atomic<Page*>> pages;
+		};
+
+		std::atomic<Directory*> m_Directory;
+
+		std::mutex m_WriteMx;
+		std::vector<std::unique_ptr<Page>> m_RetiredPages;
+		std::vector<std::unique_ptr<Page>> m_CollectablePages;
+		std::vector<std::unique_ptr<Directory>> m_RetiredDirectories;
+		std::vector<std::unique_ptr<Directory>> m_CollectableDirectories;
+
+		[[nodiscard]] Page* findPage(std::size_t pageIndex) const noexcept
+		{
+			const auto* directory = m_Directory.load(std::memory_order_acquire);
+			return pageIndex < std::size(directory->pages) ? directory->pages[pageIndex].load(std::memory_order_acquire) : nullptr;
+		}
+
+		Page* makePage(std::size_t pageIndex)
+		{
+			std::scoped_lock lock{ m_WriteMx };
+			auto* directory = m_Directory.load(std::memory_order_relaxed);
+			if (std::size(directory->pages) <= pageIndex)
+			{
+				auto grownDirectory = std::make_unique<Directory>(std::max(pageIndex + 1, 2 * std::size(directory->pages)));
+				for (std::size_t i = 0; i < std::size(directory->pages); ++i)
+					grownDirectory->pages[i].store(directory->pages[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				m_RetiredDirectories.emplace_back(directory);
+				m_Directory.store(grownDirectory.get(), std::memory_order_release);
+				directory = grownDirectory.release();
+			}
+
+			if (auto* page = directory->pages[pageIndex].load(std::memory_order_relaxed))
+				return page;
+
+			auto page = std::make_unique<Page>();
+			if (pageIndex == 0)
+				page->erasedCount = 1;
+			directory->pages[pageIndex].store(page.get(), std::memory_order_release);
+			return page.release();
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,194 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_GROUP_HPP
+#define SECS_GROUP_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Concepts.hpp"
+#include "Defines.hpp"
+#include "Entity.hpp"
+#include "Query.hpp"
+#include "System.hpp"
+
+namespace secs
+{
+	template <class TOwnedList>
+	class Group;
+
+	/** \class Group
+	 * \brief Owning group, which keeps the storages of multiple Systems sorted in lockstep
+	 *
+	 * Groups are registered via World::group and are maintained at the same occasions as Queries. In contrast to Queries, a Group owns the storages of
+	 * its Component types: the first size() active Components of each owned System belong to exactly the Entities owning all of the Component types, and
+	 * the n-th Components of each storage belong to the same Entity. Iterating a Group is therefore a lockstep linear walk over multiple dense arrays
+	 * without any probing or indirection.
+	 *
+	 * Each System can be owned by at most one Group. The order of the other active Components of owned Systems is unspecified as usual.
+	 * \tparam TOwned Owned Component types, which may be const qualified.
+	 */
+	template <class... TOwned>
+	class Group<TypeList<TOwned...>> final :
+		public detail::QueryBase
+	{
+		static_assert(1 < sizeof...(TOwned), "Group needs at least two owned Component types.");
+
+		template <class T>
+		using ComponentInfo_t = typename SystemBase<std::remove_const_t<T>>::ComponentInfo;
+
+	public:
+		/**
+		 * \brief Constructor
+		 * \throws SystemError if any of the Systems is already owned by another Group.
+		 * \param systems The Systems of the owned Component types.
+		 */
+		explicit Group(SystemBase<std::remove_const_t<TOwned>>&... systems) :
+			m_Systems{ &systems... }
+		{
+			if ((systems.m_GroupOwned || ...))
+				throw SystemError("System is already owned by another Group.");
+			((systems.m_GroupOwned = true), ...);
+		}
+
+		/**
+		 * \brief Destructor
+		 *
+		 * Releases the ownership of the Systems.
+		 */
+		~Group() noexcept override
+		{
+			std::apply(
+						[](auto*... systems)
+						{
+							((systems->m_GroupOwned = false, systems->m_GroupSize = 0), ...);
+						},
+						m_Systems
+					);
+		}
+
+		/**
+		 * \brief Counts matching Entities
+		 * \return Amount of Entities owning each of the Component types.
+		 */
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return m_Size;
+		}
+
+		/**
+		 * \brief Empty
+		 * \return True if no Entity matches.
+		 */
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return m_Size == 0;
+		}
+
+		/**
+		 * \brief View over the matching Entities
+		 * \return Returns a sized random access view of references to the matching Entities in storage order.
+		 */
+		[[nodiscard]] auto entities() const noexcept
+		{
+			return std::get<0>(m_Systems)->m_ActiveComponents
+					| std::views::take(m_Size)
+					| std::views::transform([](const auto* info) -> Entity& { return *info->entity; });
+		}
+
+		/**
+		 * \brief Executes action on each matching Entity
+		 *
+		 * Components of non-const owned types are reported as changed.
+		 * \tparam TAction Invokable object with specific signature.
+		 * \param action Invokable object.
+		 */
+		template <std::invocable<Entity&, TOwned&...> TAction>
+		void forEach(TAction action) const
+		{
+			const auto infos = std::apply([](const auto*... systems) { return std::tuple{ systems->m_ActiveComponents.data()... }; }, m_Systems);
+			auto* entityInfos = std::get<0>(infos);
+			for (std::size_t i = 0; i < m_Size; ++i)
+			{
+				std::apply(
+							[&](auto*... componentInfos) { action(*entityInfos[i]->entity, access<TOwned>(*componentInfos[i])...); },
+							infos
+						);
+			}
+		}
+
+	private:
+		std::tuple<SystemBase<std::remove_const_t<TOwned>>*...> m_Systems;
+		std::size_t m_Size = 0;
+
+		template <class T>
+		[[nodiscard]] T& access(ComponentInfo_t<T>& info) const noexcept
+		{
+			if constexpr (!std::is_const_v<T>)
+				std::get<SystemBase<std::remove_const_t<T>>*>(m_Systems)->markChanged(info);
+			return info.component;
+		}
+
+		template <class T>
+		[[nodiscard]] ComponentInfo_t<T>* findInfo(const Entity& entity) const noexcept
+		{
+			using ComponentType = std::remove_const_t<T>;
+			auto* system = std::get<SystemBase<ComponentType>*>(m_Systems);
+			const auto itr = std::ranges::find(entity.m_ComponentInfos, typeid(ComponentType), &detail::ComponentStorageInfo::componentTypeIndex);
+			if (itr == std::end(entity.m_ComponentInfos) || itr->system != system || !system->hasComponent(itr->componentUid))
+				return nullptr;
+			return &*system->m_Components[itr->componentUid - 1u];
+		}
+
+		void insert(Entity& entity) override
+		{
+			const auto infos = std::tuple{ findInfo<TOwned>(entity)... };
+			if (!(isEnabledAndUngrouped<TOwned>(std::get<ComponentInfo_t<TOwned>*>(infos)) && ...))
+				return;
+
+			// the first non grouped Component is always enabled, because the group is a prefix of the enabled partition
+			std::apply([this](auto*... componentInfos) { (swapWithinSystem(*componentInfos, m_Size), ...); }, infos);
+			++m_Size;
+			std::apply([this](auto*... systems) { ((systems->m_GroupSize = m_Size), ...); }, m_Systems);
+		}
+
+		void erase(const Entity& entity) noexcept override
+		{
+			const auto infos = std::tuple{ findInfo<TOwned>(entity)... };
+			auto* firstInfo = std::get<0>(infos);
+			if (!firstInfo || m_Size <= firstInfo->activeIndex)
+				return;
+
+			--m_Size;
+			std::apply([this](auto*... componentInfos) { (swapWithinSystem(*componentInfos, m_Size), ...); }, infos);
+			std::apply([this](auto*... systems) { ((systems->m_GroupSize = m_Size), ...); }, m_Systems);
+		}
+
+		template <class T>
+		[[nodiscard]] bool isEnabledAndUngrouped(const ComponentInfo_t<T>* info) const noexcept
+		{
+			return info && m_Size <= info->activeIndex && info->activeIndex < std::get<SystemBase<std::remove_const_t<T>>*>(m_Systems)->m_EnabledCount;
+		}
+
+		template <class TInfo>
+		void swapWithinSystem(TInfo& info, std::size_t index) noexcept
+		{
+			using ComponentType = std::remove_cvref_t<decltype(info.component)>;
+			auto* system = std::get<SystemBase<ComponentType>*>(m_Systems);
+			system->swapActiveComponents(info.activeIndex, index);
+		}
+	};
+}
+
+#endif
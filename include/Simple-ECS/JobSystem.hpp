@@ -0,0 +1,561 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_JOB_SYSTEM_HPP
+#define SECS_JOB_SYSTEM_HPP
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Topology.hpp"
+
+namespace secs::detail
+{
+	struct JobState
+	{
+		// the job itself plus each unfinished child
+		std::atomic<std::size_t> unfinishedCount{ 1 };
+		std::shared_ptr<JobState> parent;
+	};
+}
+
+namespace secs
+{
+	class JobSystem;
+
+	/** \struct JobSystemConfig
+	 * \brief Configuration of a JobSystem
+	 */
+	struct JobSystemConfig
+	{
+		/**
+		 * \brief Amount of worker threads.
+		 */
+		std::size_t workerCount = 0;
+
+		/**
+		 * \brief Pins each worker to one cpu.
+		 *
+		 * Workers are distributed round robin over the NUMA nodes, thus each node receives an equal share of workers. Within a node, each worker
+		 * is pinned to a different cpu as long as there are enough of them. Pinning is only supported on Linux and ignored elsewhere.
+		 */
+		bool pinWorkers = false;
+	};
+
+	/** \struct WorkerPlacement
+	 * \brief Placement of a worker thread as reported by JobSystem::workerPlacements
+	 */
+	struct WorkerPlacement
+	{
+		/**
+		 * \brief Index of the worker.
+		 */
+		std::size_t workerIndex = 0;
+
+		/**
+		 * \brief NUMA node the worker has been assigned to.
+		 */
+		int node = 0;
+
+		/**
+		 * \brief Cpu the worker has been pinned to; -1 if the worker is not pinned.
+		 */
+		int assignedCpu = -1;
+
+		/**
+		 * \brief Cpu the worker has been observed running on when it woke up the last time; -1 if unknown.
+		 */
+		int observedCpu = -1;
+	};
+
+	/**
+	 * \brief Handle to a job started via JobSystem::run
+	 *
+	 * A job counts as finished, when it has been executed and each of its children has finished. Handles are cheap to copy and may
+	 * outlive their jobs.
+	 */
+	class JobHandle
+	{
+		friend class JobSystem;
+
+	public:
+		/**
+		 * \brief Default Constructor
+		 *
+		 * Constructs an empty handle, which counts as finished.
+		 */
+		JobHandle() noexcept = default;
+
+		/**
+		 * \brief Checks if job is finished
+		 * \return True if the job and each of its children has been executed.
+		 */
+		[[nodiscard]] bool finished() const noexcept
+		{
+			return !m_State || m_State->unfinishedCount.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+		std::shared_ptr<detail::JobState> m_State;
+
+		explicit JobHandle(std::shared_ptr<detail::JobState> state) noexcept :
+			m_State{ std::move(state) }
+		{
+		}
+	};
+
+	/**
+	 * \brief Pool of worker threads which execute submitted jobs
+	 *
+	 * Each worker owns a job queue. Jobs submitted by a worker are pushed onto its own queue and popped in LIFO order, while idle workers
+	 * steal the oldest jobs from the other queues. Jobs submitted from any other thread go into a shared queue. Threads which have to wait
+	 * for the completion of specific jobs should use waitFor or waitUntil, which execute pending jobs on the calling thread while waiting.
+	 * Jobs started via run may have child jobs, thus fine grained work can be spawned recursively and awaited as a whole.
+	 * Workers can be pinned to cpus and are assigned to NUMA nodes (see JobSystemConfig). Jobs which must run on a specific node can be bound
+	 * to one of its workers via runOnWorker.
+	 * A JobSystem without any workers is valid; each job will then be executed by the waiting thread.
+	 * \remark Jobs must not throw. An exception leaving a job results in std::terminate.
+	 */
+	class JobSystem
+	{
+	public:
+		/**
+		 * \brief Alias for the type of executable jobs.
+		 */
+		using Job = std::function<void()>;
+
+		/**
+		 * \brief Default Constructor
+		 *
+		 * Constructs a JobSystem without any worker threads.
+		 */
+		JobSystem() = default;
+
+		/**
+		 * \brief Constructor
+		 * \param workerCount Amount of worker threads which will be started.
+		 */
+		explicit JobSystem(std::size_t workerCount) :
+			JobSystem{ JobSystemConfig{ .workerCount = workerCount } }
+		{
+		}
+
+		/**
+		 * \brief Constructor
+		 * \param config The configuration.
+		 */
+		explicit JobSystem(const JobSystemConfig& config) :
+			m_NodeCount{ 1 }
+		{
+			const auto workerCount = config.workerCount;
+			m_Queues.reserve(workerCount);
+			for (std::size_t i = 0; i < workerCount; ++i)
+				m_Queues.emplace_back(std::make_unique<JobQueue>());
+
+			if (workerCount != 0)
+			{
+				const auto topology = detail::queryNumaTopology();
+				m_NodeCount = std::size(topology);
+				m_WorkerInfos = std::make_unique<WorkerInfo[]>(workerCount);
+				for (std::size_t i = 0; i < workerCount; ++i)
+				{
+					const auto& node = topology[i % std::size(topology)];
+					m_WorkerInfos[i].node = node.id;
+					if (config.pinWorkers)
+						m_WorkerInfos[i].assignedCpu = node.cpus[i / std::size(topology) % std::size(node.cpus)];
+				}
+			}
+
+			m_Workers.reserve(workerCount);
+			for (std::size_t i = 0; i < workerCount; ++i)
+				m_Workers.emplace_back([this, i](std::stop_token stopToken) { workerLoop(stopToken, i); });
+		}
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator =(const JobSystem&) = delete;
+		JobSystem(JobSystem&&) = delete;
+		JobSystem& operator =(JobSystem&&) = delete;
+
+		/**
+		 * \brief Destructor
+		 *
+		 * Stops and joins all worker threads. Jobs which have not been started yet will be discarded.
+		 */
+		~JobSystem() noexcept
+		{
+			for (auto& worker : m_Workers)
+				worker.request_stop();
+			m_SleepCv.notify_all();
+		}
+
+		/**
+		 * \brief Amount of worker threads
+		 * \return Returns the amount of worker threads.
+		 */
+		[[nodiscard]] std::size_t workerCount() const noexcept
+		{
+			return std::size(m_Workers);
+		}
+
+		/**
+		 * \brief Amount of NUMA nodes
+		 * \return Returns the amount of NUMA nodes the workers are distributed over.
+		 */
+		[[nodiscard]] std::size_t nodeCount() const noexcept
+		{
+			return m_NodeCount;
+		}
+
+		/**
+		 * \brief Searches for a worker on a NUMA node
+		 * \param node Id of the NUMA node.
+		 * \param hint Workers of the node are selected round robin by this value.
+		 * \return Returns the index of a worker, which has been assigned to the node, or std::nullopt if there is none.
+		 */
+		[[nodiscard]] std::optional<std::size_t> findWorkerOnNode(int node, std::size_t hint = 0) const noexcept
+		{
+			std::size_t candidateCount = 0;
+			for (std::size_t i = 0; i < workerCount(); ++i)
+				candidateCount += m_WorkerInfos[i].node == node;
+
+			if (candidateCount == 0)
+				return std::nullopt;
+
+			for (std::size_t i = 0, candidate = hint % candidateCount; i < workerCount(); ++i)
+			{
+				if (m_WorkerInfos[i].node == node && candidate-- == 0)
+					return i;
+			}
+			return std::nullopt;
+		}
+
+		/**
+		 * \brief Reports the placement of each worker
+		 * \return Returns the assigned and observed placement of each worker.
+		 */
+		[[nodiscard]] std::vector<WorkerPlacement> workerPlacements() const
+		{
+			std::vector<WorkerPlacement> placements;
+			placements.reserve(workerCount());
+			for (std::size_t i = 0; i < workerCount(); ++i)
+			{
+				auto& info = m_WorkerInfos[i];
+				placements.push_back({ i, info.node, info.assignedCpu.load(), info.observedCpu.load(std::memory_order_relaxed) });
+			}
+			return placements;
+		}
+
+		/**
+		 * \brief Submits a job
+		 *
+		 * The job will be executed by any worker thread or by a thread which is currently waiting via waitUntil.
+		 * \param job The job to be executed.
+		 */
+		void submit(Job job)
+		{
+			auto& queue = currentWorkerIndex() < std::size(m_Queues) ? *m_Queues[currentWorkerIndex()] : m_SharedQueue;
+			// the counter is incremented in advance, thus it never falls below the actual amount of queued jobs
+			++m_QueuedJobCount;
+			{
+				std::scoped_lock lock{ queue.mx };
+				try
+				{
+					queue.jobs.emplace_back(std::move(job));
+				}
+				catch (...)
+				{
+					--m_QueuedJobCount;
+					throw;
+				}
+			}
+			{
+				// synchronizes with sleeping workers, thus the notification can not get lost
+				std::scoped_lock lock{ m_SleepMx };
+			}
+			m_SleepCv.notify_one();
+		}
+
+		/**
+		 * \brief Starts a job
+		 *
+		 * Similar to submit, but the returned handle can be used to wait for the job and to attach child jobs to it. The parent will not count
+		 * as finished until each of its children has finished, even if the parent itself has already been executed. Thus children must be
+		 * attached while the parent is still unfinished, which is always the case from within the parent or any of its children. For that purpose
+		 * the job may accept its own handle as parameter.
+		 * \tparam TJob Invokable type, either without parameters or with a const JobHandle& parameter.
+		 * \param job The job to be executed.
+		 * \param parent Handle of the parent job. An empty handle results in a job without parent.
+		 * \return Handle to the started job.
+		 */
+		template <class TJob>
+			requires std::invocable<TJob&> || std::invocable<TJob&, const JobHandle&>
+		JobHandle run(TJob job, const JobHandle& parent = {})
+		{
+			auto [wrappedJob, handle] = wrapJob(std::move(job), parent);
+			submit(std::move(wrappedJob));
+			return handle;
+		}
+
+		/**
+		 * \brief Starts a job on a specific worker
+		 *
+		 * Similar to run, but the job will only be executed by the specified worker and is never stolen by others. This may be used for work
+		 * which has to happen on a specific NUMA node, e.g. first touching memory.
+		 * \tparam TJob Invokable type, either without parameters or with a const JobHandle& parameter.
+		 * \param workerIndex Index of the worker. Must be less than workerCount.
+		 * \param job The job to be executed.
+		 * \param parent Handle of the parent job. An empty handle results in a job without parent.
+		 * \return Handle to the started job.
+		 */
+		template <class TJob>
+			requires std::invocable<TJob&> || std::invocable<TJob&, const JobHandle&>
+		JobHandle runOnWorker(std::size_t workerIndex, TJob job, const JobHandle& parent = {})
+		{
+			assert(workerIndex < workerCount());
+			auto [wrappedJob, handle] = wrapJob(std::move(job), parent);
+
+			auto& queue = *m_Queues[workerIndex];
+			++queue.pinnedJobCount;
+			{
+				std::scoped_lock lock{ queue.mx };
+				try
+				{
+					queue.pinnedJobs.emplace_back(std::move(wrappedJob));
+				}
+				catch (...)
+				{
+					--queue.pinnedJobCount;
+					throw;
+				}
+			}
+			{
+				std::scoped_lock lock{ m_SleepMx };
+			}
+			// the notification must reach that specific worker
+			m_SleepCv.notify_all();
+			return handle;
+		}
+
+		/**
+		 * \brief Waits for a job
+		 *
+		 * The calling thread executes pending jobs while waiting, thus this may also be called from within other jobs.
+		 * \param handle Handle of the job to wait for.
+		 */
+		void waitFor(const JobHandle& handle) noexcept
+		{
+			waitUntil([&handle] { return handle.finished(); });
+		}
+
+		/**
+		 * \brief Executes one pending job on the calling thread
+		 * \return True if a job has been executed.
+		 */
+		bool tryExecuteJob() noexcept
+		{
+			if (auto job = takeJob(currentWorkerIndex()))
+			{
+				job();
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		 * \brief Waits until the predicate is satisfied
+		 *
+		 * The calling thread executes pending jobs while waiting, thus it is safe to wait for jobs even if there are no workers at all.
+		 * \tparam TPredicate Invokable predicate type.
+		 * \param predicate The condition the calling thread waits for.
+		 */
+		template <std::predicate TPredicate>
+		void waitUntil(TPredicate predicate) noexcept
+		{
+			while (!predicate())
+			{
+				if (!tryExecuteJob())
+					std::this_thread::yield();
+			}
+		}
+
+	private:
+		struct JobQueue
+		{
+			std::mutex mx;
+			std::deque<Job> jobs;
+			// only executed by the owning worker and not part of m_QueuedJobCount
+			std::deque<Job> pinnedJobs;
+			std::atomic<std::size_t> pinnedJobCount{ 0 };
+		};
+
+		struct WorkerInfo
+		{
+			int node = 0;
+			// reset by the worker, if pinning fails
+			std::atomic<int> assignedCpu{ -1 };
+			std::atomic<int> observedCpu{ -1 };
+		};
+
+		struct WorkerContext
+		{
+			const JobSystem* jobSystem = nullptr;
+			std::size_t index = 0;
+		};
+
+		JobQueue m_SharedQueue;
+		std::vector<std::unique_ptr<JobQueue>> m_Queues;
+		std::atomic<std::size_t> m_QueuedJobCount{ 0 };
+		std::size_t m_NodeCount = 1;
+		std::unique_ptr<WorkerInfo[]> m_WorkerInfos;
+		std::mutex m_SleepMx;
+		std::condition_variable_any m_SleepCv;
+		// must be the last member, thus the threads are joined before any other member gets destructed
+		std::vector<std::jthread> m_Workers;
+
+		template <class TJob>
+		[[nodiscard]] static std::pair<Job, JobHandle> wrapJob(TJob job, const JobHandle& parent)
+		{
+			auto state = std::make_shared<detail::JobState>();
+			if (parent.m_State)
+			{
+				assert(!parent.finished());
+				++parent.m_State->unfinishedCount;
+				state->parent = parent.m_State;
+			}
+
+			Job wrappedJob = [job = std::move(job), state]() mutable
+			{
+				if constexpr (std::invocable<TJob&, const JobHandle&>)
+					job(JobHandle{ state });
+				else
+					job();
+				finish(*state);
+			};
+			return { std::move(wrappedJob), JobHandle{ std::move(state) } };
+		}
+
+		static void finish(detail::JobState& state) noexcept
+		{
+			for (auto* current = &state; current && --current->unfinishedCount == 0; current = current->parent.get())
+			{
+			}
+		}
+
+		[[nodiscard]] static WorkerContext& workerContext() noexcept
+		{
+			static thread_local WorkerContext context;
+			return context;
+		}
+
+		// returns an invalid index for threads which are not owned by this JobSystem
+		[[nodiscard]] std::size_t currentWorkerIndex() const noexcept
+		{
+			const auto& context = workerContext();
+			return context.jobSystem == this ? context.index : std::size(m_Queues);
+		}
+
+		Job takeJob(std::size_t workerIndex)
+		{
+			auto popBack = [this](JobQueue& queue) -> Job
+			{
+				std::scoped_lock lock{ queue.mx };
+				if (std::empty(queue.jobs))
+					return {};
+				auto job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				--m_QueuedJobCount;
+				return job;
+			};
+
+			auto popFront = [this](JobQueue& queue) -> Job
+			{
+				std::scoped_lock lock{ queue.mx };
+				if (std::empty(queue.jobs))
+					return {};
+				auto job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				--m_QueuedJobCount;
+				return job;
+			};
+
+			if (workerIndex < std::size(m_Queues))
+			{
+				if (auto& queue = *m_Queues[workerIndex]; queue.pinnedJobCount != 0)
+				{
+					std::scoped_lock lock{ queue.mx };
+					if (!std::empty(queue.pinnedJobs))
+					{
+						auto job = std::move(queue.pinnedJobs.front());
+						queue.pinnedJobs.pop_front();
+						--queue.pinnedJobCount;
+						return job;
+					}
+				}
+			}
+
+			if (m_QueuedJobCount == 0)
+				return {};
+
+			if (workerIndex < std::size(m_Queues))
+			{
+				if (auto job = popBack(*m_Queues[workerIndex]))
+					return job;
+			}
+
+			if (auto job = popFront(m_SharedQueue))
+				return job;
+
+			// steal from the other workers, beginning with the successor of the current one
+			for (std::size_t i = 1; i <= std::size(m_Queues); ++i)
+			{
+				const auto victimIndex = (workerIndex + i) % std::size(m_Queues);
+				if (victimIndex == workerIndex)
+					continue;
+				if (auto job = popFront(*m_Queues[victimIndex]))
+					return job;
+			}
+			return {};
+		}
+
+		void workerLoop(std::stop_token stopToken, std::size_t index) noexcept
+		{
+			workerContext() = { this, index };
+			auto& info = m_WorkerInfos[index];
+			if (const auto cpu = info.assignedCpu.load(); cpu != -1 && !detail::pinCurrentThread(cpu))
+				info.assignedCpu = -1;
+			info.observedCpu.store(detail::currentCpu(), std::memory_order_relaxed);
+
+			const auto& queue = *m_Queues[index];
+			while (!stopToken.stop_requested())
+			{
+				if (auto job = takeJob(index))
+				{
+					job();
+					continue;
+				}
+
+				std::unique_lock lock{ m_SleepMx };
+				m_SleepCv.wait(lock, stopToken, [this, &queue] { return m_QueuedJobCount != 0 || queue.pinnedJobCount != 0; });
+				info.observedCpu.store(detail::currentCpu(), std::memory_order_relaxed);
+			}
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,189 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_OBSERVER_HPP
+#define SECS_OBSERVER_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <typeindex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Concepts.hpp"
+#include "Defines.hpp"
+
+namespace secs
+{
+	class World;
+
+	/** \struct Added
+	 * \brief Observer event tag for Entities with a TComponent, which changed their state to running while being enabled, or which have been
+	 * enabled while running
+	 */
+	template <Component TComponent>
+	struct Added
+	{
+	};
+
+	/** \struct Removed
+	 * \brief Observer event tag for Entities with a TComponent, which changed their state to teardown while being enabled, or which have been
+	 * disabled while running
+	 */
+	template <Component TComponent>
+	struct Removed
+	{
+	};
+
+	/** \struct Changed
+	 * \brief Observer event tag for running and enabled Entities, whose TComponent has been mutably accessed
+	 *
+	 * See SystemBase::changeVersion for details about which accesses count as change.
+	 */
+	template <Component TComponent>
+	struct Changed
+	{
+	};
+
+	/** \struct With
+	 * \brief Observer filter, which requires the observed Entities to own each of the TComponent types
+	 */
+	template <Component... TComponent>
+	struct With
+	{
+	};
+
+	/**
+	 * \brief Kind of events an Observer reacts on
+	 */
+	enum class ObserverEvent
+	{
+		added,
+		removed,
+		changed
+	};
+
+	/** \class Observer
+	 * \brief Accumulates Entities matching an event
+	 *
+	 * Observers are created via World::observe. The World feeds them during postUpdate: Added and Removed events when enabled Entities enter their
+	 * running or teardown states or when running Entities become enabled or disabled, Changed events after each System has been post updated.
+	 * Matching Entity uids accumulate until they are drained, thus consumers only process what happened since their previous drain instead of
+	 * scanning each Component. As an Entity may be disabled and enabled again before a drain, consumers should resolve Added and Removed events by
+	 * the current state of the Entity.
+	 *
+	 * Entities of drained Removed events are still accessible via World::findEntity until the next postUpdate. The World must not be post updated
+	 * concurrently to draining.
+	 */
+	class Observer
+	{
+		friend class World;
+
+	public:
+		Observer(const Observer&) = delete;
+		Observer& operator =(const Observer&) = delete;
+		Observer(Observer&&) = delete;
+		Observer& operator =(Observer&&) = delete;
+
+		/**
+		 * \brief Observed event
+		 * \return Returns the kind of events.
+		 */
+		[[nodiscard]] ObserverEvent event() const noexcept
+		{
+			return m_Event;
+		}
+
+		/**
+		 * \brief Checks for pending Entities
+		 * \return True if nothing has been accumulated since the previous drain.
+		 */
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return std::empty(m_Uids);
+		}
+
+		/**
+		 * \brief Takes the accumulated Entities
+		 * \return Returns the uids of the Entities, which matched since the previous drain, in ascending order and without duplicates.
+		 */
+		[[nodiscard]] std::vector<Uid> drain()
+		{
+			auto uids = std::exchange(m_Uids, {});
+			std::ranges::sort(uids);
+			uids.erase(std::unique(std::begin(uids), std::end(uids)), std::end(uids));
+			return uids;
+		}
+
+	private:
+		using CollectChangesFn_t = void(World&, Observer&);
+
+		ObserverEvent m_Event;
+		std::type_index m_ComponentType;
+		std::vector<std::type_index> m_Filter;
+		std::vector<Uid> m_Uids;
+		// only used for changed events
+		CollectChangesFn_t* m_CollectChanges = nullptr;
+		std::uint64_t m_ChangeVersion = 0;
+
+		Observer(ObserverEvent event, std::type_index componentType, std::vector<std::type_index> filter) :
+			m_Event{ event },
+			m_ComponentType{ componentType },
+			m_Filter{ std::move(filter) }
+		{
+		}
+	};
+}
+
+namespace secs::detail
+{
+	template <class TEvent>
+	struct ObserverEventTraits;
+
+	template <class TComponent>
+	struct ObserverEventTraits<Added<TComponent>>
+	{
+		using ComponentType = TComponent;
+		static constexpr ObserverEvent event = ObserverEvent::added;
+	};
+
+	template <class TComponent>
+	struct ObserverEventTraits<Removed<TComponent>>
+	{
+		using ComponentType = TComponent;
+		static constexpr ObserverEvent event = ObserverEvent::removed;
+	};
+
+	template <class TComponent>
+	struct ObserverEventTraits<Changed<TComponent>>
+	{
+		using ComponentType = TComponent;
+		static constexpr ObserverEvent event = ObserverEvent::changed;
+	};
+
+	template <class TFilter>
+	struct ObserverFilterTraits;
+
+	template <class... TComponent>
+	struct ObserverFilterTraits<With<TComponent...>>
+	{
+		[[nodiscard]] static std::vector<std::type_index> types()
+		{
+			return { typeid(std::remove_cvref_t<TComponent>)... };
+		}
+	};
+
+	template <class T>
+	concept ObserverEventTag = requires { ObserverEventTraits<T>::event; };
+
+	template <class T>
+	concept ObserverFilterTag = requires { ObserverFilterTraits<T>::types(); };
+}
+
+#endif
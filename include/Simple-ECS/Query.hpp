@@ -0,0 +1,196 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_QUERY_HPP
+#define SECS_QUERY_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Concepts.hpp"
+#include "Defines.hpp"
+#include "Entity.hpp"
+#include "System.hpp"
+
+namespace secs::detail
+{
+	class QueryBase
+	{
+	public:
+		QueryBase() = default;
+		QueryBase(const QueryBase&) = delete;
+		QueryBase& operator =(const QueryBase&) = delete;
+		QueryBase(QueryBase&&) = delete;
+		QueryBase& operator =(QueryBase&&) = delete;
+
+		virtual ~QueryBase() noexcept = default;
+
+		// Adds the Entity if it matches and is not already part of the Query.
+		virtual void insert(Entity& entity) = 0;
+		virtual void erase(const Entity& entity) noexcept = 0;
+
+		// Called during each postUpdate after the Systems have been post updated.
+		virtual void collectChanges()
+		{
+		}
+	};
+}
+
+namespace secs
+{
+	template <class TIncludeList, class TExcludeList = TypeList<>>
+	class Query;
+
+	/** \class Query
+	 * \brief Persistent query, whose matching Entities are maintained incrementally by the World
+	 *
+	 * Queries are registered via World::query and match the same Entities as a View with the same Component types, except that disabled Entities are
+	 * not part of any Query. In contrast to Views, the World updates the matching set whenever Entities enter their initializing state, are enabled or
+	 * disabled, or are destroyed, thus iterating a Query is a linear walk over a dense list of cached Component references without any probing.
+	 * Each Query type is registered at most once per World, thus multiple Systems share the same instance.
+	 *
+	 * The matching set changes only during the World's postUpdate, thus Queries may be iterated concurrently from multiple Systems as long as their
+	 * accesses to the Components do not conflict.
+	 * \tparam TInclude Included Component types, which may be const qualified.
+	 * \tparam TExclude Excluded Component types.
+	 */
+	template <class... TInclude, class... TExclude>
+	class Query<TypeList<TInclude...>, TypeList<TExclude...>> final :
+		public detail::QueryBase
+	{
+		static_assert(0 < sizeof...(TInclude), "Query needs at least one included Component type.");
+
+		template <class T>
+		using ComponentInfo_t = typename SystemBase<std::remove_const_t<T>>::ComponentInfo;
+
+		struct Entry
+		{
+			Entity* entity;
+			std::tuple<ComponentInfo_t<TInclude>*...> components;
+		};
+
+	public:
+		/**
+		 * \brief Constructor
+		 * \param systems The Systems of the included Component types.
+		 */
+		explicit Query(SystemBase<std::remove_const_t<TInclude>>&... systems) noexcept :
+			m_Systems{ &systems... }
+		{
+		}
+
+		/**
+		 * \brief Counts matching Entities
+		 * \return Amount of matching Entities.
+		 */
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return std::size(m_Entries);
+		}
+
+		/**
+		 * \brief Empty
+		 * \return True if no Entity matches.
+		 */
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return std::empty(m_Entries);
+		}
+
+		/**
+		 * \brief View over the matching Entities
+		 * \return Returns a sized random access view of references to the matching Entities in no particular order.
+		 */
+		[[nodiscard]] auto entities() const noexcept
+		{
+			return m_Entries | std::views::transform([](const Entry& entry) -> Entity& { return *entry.entity; });
+		}
+
+		/**
+		 * \brief Executes action on each matching Entity
+		 *
+		 * Components of non-const included types are reported as changed.
+		 * \tparam TAction Invokable object with specific signature.
+		 * \param action Invokable object.
+		 */
+		template <std::invocable<Entity&, TInclude&...> TAction>
+		void forEach(TAction action) const
+		{
+			for (const auto& entry : m_Entries)
+			{
+				std::apply(
+							[&](auto*... infos) { action(*entry.entity, access<TInclude>(*infos)...); },
+							entry.components
+						);
+			}
+		}
+
+	private:
+		std::tuple<SystemBase<std::remove_const_t<TInclude>>*...> m_Systems;
+		std::vector<Entry> m_Entries;
+		// maps Entity uids to their position in m_Entries
+		std::unordered_map<Uid, std::size_t> m_Indices;
+
+		template <class T>
+		[[nodiscard]] T& access(ComponentInfo_t<T>& info) const noexcept
+		{
+			if constexpr (!std::is_const_v<T>)
+				std::get<SystemBase<std::remove_const_t<T>>*>(m_Systems)->markChanged(info);
+			return info.component;
+		}
+
+		template <class T>
+		[[nodiscard]] ComponentInfo_t<T>* findInfo(const Entity& entity) const noexcept
+		{
+			using ComponentType = std::remove_const_t<T>;
+			auto* system = std::get<SystemBase<ComponentType>*>(m_Systems);
+			const auto itr = std::ranges::find(entity.m_ComponentInfos, typeid(ComponentType), &detail::ComponentStorageInfo::componentTypeIndex);
+			if (itr == std::end(entity.m_ComponentInfos) || itr->system != system || !system->hasComponent(itr->componentUid))
+				return nullptr;
+			return &*system->m_Components[itr->componentUid - 1u];
+		}
+
+		void insert(Entity& entity) override
+		{
+			if (m_Indices.contains(entity.uid()) || (entity.template hasComponent<TExclude>() || ...))
+				return;
+
+			Entry entry{ &entity, { findInfo<TInclude>(entity)... } };
+			if (std::apply([](const auto*... infos) { return ((infos != nullptr) && ...); }, entry.components))
+			{
+				m_Indices.emplace(entity.uid(), std::size(m_Entries));
+				m_Entries.emplace_back(entry);
+			}
+		}
+
+		void erase(const Entity& entity) noexcept override
+		{
+			const auto itr = m_Indices.find(entity.uid());
+			if (itr == std::end(m_Indices))
+				return;
+
+			const auto index = itr->second;
+			m_Indices.erase(itr);
+			if (index + 1u != std::size(m_Entries))
+			{
+				m_Entries[index] = m_Entries.back();
+				m_Indices.find(m_Entries[index].entity->uid())->second = index;
+			}
+			m_Entries.pop_back();
+		}
+	};
+}
+
+#endif
@@ -8,10 +8,23 @@
 
 #pragma once
 
+#include "Simple-ECS/Broadphase.hpp"
+#include "Simple-ECS/ComponentHandle.hpp"
+#include "Simple-ECS/ComponentIndex.hpp"
+#include "Simple-ECS/ComponentTracker.hpp"
 #include "Simple-ECS/Concepts.hpp"
 #include "Simple-ECS/Defines.hpp"
+#include "Simple-ECS/DoubleBuffered.hpp"
 #include "Simple-ECS/Entity.hpp"
+#include "Simple-ECS/Group.hpp"
+#include "Simple-ECS/JobSystem.hpp"
+#include "Simple-ECS/Observer.hpp"
+#include "Simple-ECS/Query.hpp"
+#include "Simple-ECS/SpatialGrid.hpp"
 #include "Simple-ECS/System.hpp"
+#include "Simple-ECS/Task.hpp"
+#include "Simple-ECS/TickDriver.hpp"
+#include "Simple-ECS/View.hpp"
 #include "Simple-ECS/World.hpp"
 
 #endif
@@ -0,0 +1,541 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_SPATIAL_GRID_HPP
+#define SECS_SPATIAL_GRID_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ComponentHandle.hpp"
+#include "ComponentTracker.hpp"
+#include "World.hpp"
+
+namespace secs
+{
+	/** \typedef SpatialPosition
+	 * \brief Position type used by SpatialGrid. 2D users may simply leave the last coordinate at zero.
+	 */
+	using SpatialPosition = std::array<float, 3>;
+
+	/** \class SpatialGrid
+	 * \brief Uniform grid of Entity positions, which is maintained incrementally
+	 *
+	 * The grid indexes each running and enabled Entity owning a TComponent by the position returned from the projection. It uses a ComponentTracker,
+	 * thus update only processes the Entities which have been added, removed, enabled, disabled or whose TComponent has been changed since the
+	 * previous call; the grid is never rebuilt from scratch. Entities, which are already running and enabled during construction, are inserted
+	 * immediately.
+	 *
+	 * Cells are hashed, thus the grid is unbounded and only occupied cells consume memory. The cell size should be in the range of the typical
+	 * query radius. All queries are const and may be issued concurrently, but not concurrently to update.
+	 * \tparam TComponent Component type holding the position.
+	 * \tparam TProjection Invokable type, which returns the SpatialPosition of a const TComponent&.
+	 */
+	template <Component TComponent, class TProjection = std::identity>
+		requires std::convertible_to<std::invoke_result_t<const TProjection&, const TComponent&>, SpatialPosition>
+	class SpatialGrid
+	{
+	public:
+		/**
+		 * \brief Constructor
+		 * \throws SystemError if the System of TComponent could not be found.
+		 * \param world The World, whose Entities will be indexed. Must outlive the grid.
+		 * \param cellSize Edge length of each cell. Must be greater than zero.
+		 * \param projection Invokable object, which returns the position of a Component.
+		 */
+		SpatialGrid(World& world, float cellSize, TProjection projection = TProjection{}) :
+			m_World{ world },
+			m_CellSize{ cellSize },
+			m_InverseCellSize{ 1.f / cellSize },
+			m_Projection{ std::move(projection) },
+			m_Tracker{ world }
+		{
+			assert(0 < cellSize);
+			m_Tracker.seed([this](Entity& entity) { insert(entity); });
+		}
+
+		SpatialGrid(const SpatialGrid&) = delete;
+		SpatialGrid& operator =(const SpatialGrid&) = delete;
+		SpatialGrid(SpatialGrid&&) = delete;
+		SpatialGrid& operator =(SpatialGrid&&) = delete;
+
+		/**
+		 * \brief Indexed Entity count
+		 * \return Returns the amount of indexed Entities.
+		 */
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return std::size(m_Entries);
+		}
+
+		/**
+		 * \brief Edge length of the cells
+		 * \return Returns the cell size.
+		 */
+		[[nodiscard]] float cellSize() const noexcept
+		{
+			return m_CellSize;
+		}
+
+		/**
+		 * \brief Applies the events collected since the previous call
+		 *
+		 * Should be called once per frame after the World's postUpdate, e.g. in a preUpdate, but not concurrently to any query.
+		 */
+		void update()
+		{
+			m_Tracker.update(
+							[this](Uid uid) { erase(uid); },
+							[this](Entity& entity) { insert(entity); },
+							[this](Uid uid)
+							{
+								if (auto itr = m_Entries.find(uid); itr != std::end(m_Entries))
+								{
+									if (const auto* component = itr->second.handle.get())
+										move(uid, itr->second, position(*component));
+								}
+							}
+							);
+
+			if (m_OccupiedBoundsDirty)
+				recalculateOccupiedBounds();
+		}
+
+		/**
+		 * \brief Queries the position of an indexed Entity
+		 * \param uid Uid of the Entity.
+		 * \return Returns the indexed position or nullptr if the Entity is not indexed.
+		 */
+		[[nodiscard]] const SpatialPosition* findPosition(Uid uid) const noexcept
+		{
+			if (auto itr = m_Entries.find(uid); itr != std::end(m_Entries))
+				return &m_Cells.find(itr->second.cell)->second[itr->second.slot].position;
+			return nullptr;
+		}
+
+		/**
+		 * \brief Executes action on each Entity inside a sphere
+		 * \tparam TAction Invokable object with specific signature.
+		 * \param center Center of the sphere.
+		 * \param radius Radius of the sphere.
+		 * \param action Invokable object, which receives the uid and position of each Entity.
+		 */
+		template <std::invocable<Uid, const SpatialPosition&> TAction>
+		void forEachInRadius(const SpatialPosition& center, float radius, TAction action) const
+		{
+			const auto squaredRadius = radius * radius;
+			forEachInBox(
+						{ center[0] - radius, center[1] - radius, center[2] - radius },
+						{ center[0] + radius, center[1] + radius, center[2] + radius },
+						[&](Uid uid, const SpatialPosition& position)
+						{
+							if (squaredDistance(center, position) <= squaredRadius)
+								action(uid, position);
+						}
+						);
+		}
+
+		/**
+		 * \brief Executes action on each Entity inside an axis aligned box
+		 * \tparam TAction Invokable object with specific signature.
+		 * \param min Minimal corner of the box.
+		 * \param max Maximal corner of the box.
+		 * \param action Invokable object, which receives the uid and position of each Entity.
+		 */
+		template <std::invocable<Uid, const SpatialPosition&> TAction>
+		void forEachInBox(const SpatialPosition& min, const SpatialPosition& max, TAction action) const
+		{
+			auto visitItems = [&](const std::vector<CellItem>& items)
+			{
+				for (const auto& item : items)
+				{
+					if (contains(min, max, item.position))
+						action(item.uid, item.position);
+				}
+			};
+
+			// cells outside of the occupied bounds are guaranteed to be empty
+			auto minCell = cellCoordinates(min);
+			auto maxCell = cellCoordinates(max);
+			std::uint64_t cellCount = 1;
+			bool aliases = false;
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				minCell[axis] = std::max(minCell[axis], m_OccupiedMin[axis]);
+				maxCell[axis] = std::min(maxCell[axis], m_OccupiedMax[axis]);
+				if (maxCell[axis] < minCell[axis])
+					return;
+
+				const auto extent = static_cast<std::uint64_t>(maxCell[axis] - minCell[axis]) + 1u;
+				aliases = aliases || cellKeyPeriod <= extent;
+				// at most 2^63 in total, thus it never overflows
+				cellCount *= std::min(extent, cellKeyPeriod);
+			}
+
+			// Visiting each occupied cell is cheaper for large boxes and does not visit aliased cells multiple times.
+			if (aliases || std::size(m_Cells) < cellCount)
+			{
+				for (const auto& [key, items] : m_Cells)
+					visitItems(items);
+				return;
+			}
+
+			for (auto x = minCell[0]; x <= maxCell[0]; ++x)
+			{
+				for (auto y = minCell[1]; y <= maxCell[1]; ++y)
+				{
+					for (auto z = minCell[2]; z <= maxCell[2]; ++z)
+					{
+						if (const auto itr = m_Cells.find(cellKey({ x, y, z })); itr != std::end(m_Cells))
+							visitItems(itr->second);
+					}
+				}
+			}
+		}
+
+		/**
+		 * \brief Queries the nearest Entities
+		 *
+		 * Cells are searched in growing rings around the center, until either each indexed Entity has been found or no unsearched cell can
+		 * contain a nearer Entity.
+		 * \param center The reference position.
+		 * \param count Maximal amount of Entities.
+		 * \return Returns the uids of the nearest Entities sorted by their distance.
+		 */
+		[[nodiscard]] std::vector<Uid> nearest(const SpatialPosition& center, std::size_t count) const
+		{
+			using Candidate = std::pair<float, Uid>;
+			std::priority_queue<Candidate> candidates;
+			if (count == 0 || std::empty(m_Entries))
+				return {};
+
+			count = std::min(count, std::size(m_Entries));
+
+			const auto centerCell = cellCoordinates(center);
+			std::int64_t maxRing = 0;
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				maxRing = std::max(
+									{ maxRing, m_OccupiedMax[axis] - centerCell[axis], centerCell[axis] - m_OccupiedMin[axis] }
+								);
+			}
+
+			for (std::int64_t ring = 0; ring <= maxRing; ++ring)
+			{
+				forEachCellOnRing(
+								centerCell,
+								ring,
+								[&](const std::vector<CellItem>& items)
+								{
+									for (const auto& item : items)
+									{
+										const auto distance = squaredDistance(center, item.position);
+										if (std::size(candidates) < count)
+											candidates.emplace(distance, item.uid);
+										else if (distance < candidates.top().first)
+										{
+											candidates.pop();
+											candidates.emplace(distance, item.uid);
+										}
+									}
+								}
+								);
+
+				if (std::size(candidates) < count)
+					continue;
+
+				// each unsearched cell is at least ring cell sizes away
+				const auto searchedDistance = static_cast<float>(ring) * m_CellSize;
+				if (count == std::size(m_Entries) || candidates.top().first <= searchedDistance * searchedDistance)
+					break;
+			}
+
+			std::vector<Uid> result(std::size(candidates));
+			for (auto itr = std::rbegin(result); itr != std::rend(result); ++itr)
+			{
+				*itr = candidates.top().second;
+				candidates.pop();
+			}
+			return result;
+		}
+
+		/**
+		 * \brief Executes multiple sphere queries in parallel
+		 *
+		 * The queries are distributed over the JobSystem of the World.
+		 * \param centers Centers of the spheres.
+		 * \param radius Radius of each sphere.
+		 * \param results Receives the uids of the Entities inside each sphere; must have the same size as centers. Previous contents are cleared.
+		 * \param grainSize Maximal amount of queries which will be processed as one unit.
+		 */
+		void batchInRadius(
+			std::span<const SpatialPosition> centers,
+			float radius,
+			std::span<std::vector<Uid>> results,
+			std::size_t grainSize = 64
+		) const
+		{
+			assert(std::size(centers) == std::size(results));
+			auto processRange = [&](std::size_t first, std::size_t last)
+			{
+				for (; first != last; ++first)
+				{
+					auto& result = results[first];
+					result.clear();
+					forEachInRadius(centers[first], radius, [&result](Uid uid, const SpatialPosition&) { result.emplace_back(uid); });
+				}
+			};
+
+			auto& jobSystem = m_World.jobSystem();
+			grainSize = std::max<std::size_t>(grainSize, 1);
+			if (jobSystem.workerCount() == 0 || std::size(centers) <= grainSize)
+			{
+				processRange(0, std::size(centers));
+				return;
+			}
+
+			auto root = jobSystem.run(
+									[&](const JobHandle& self)
+									{
+										for (std::size_t first = 0; first < std::size(centers); first += grainSize)
+										{
+											const auto last = std::min(first + grainSize, std::size(centers));
+											jobSystem.run([&processRange, first, last] { processRange(first, last); }, self);
+										}
+									}
+								);
+			jobSystem.waitFor(root);
+		}
+
+	private:
+		using CellCoordinates = std::array<std::int64_t, 3>;
+
+		struct CellItem
+		{
+			SpatialPosition position;
+			Uid uid;
+		};
+
+		struct Entry
+		{
+			std::uint64_t cell;
+			// position inside the cell
+			std::size_t slot;
+			ComponentHandle<const TComponent> handle;
+		};
+
+		World& m_World;
+		float m_CellSize;
+		float m_InverseCellSize;
+		TProjection m_Projection;
+		ComponentTracker<TComponent> m_Tracker;
+		// Cells are kept after they became empty, thus oscillating Entities do not allocate.
+		std::unordered_map<std::uint64_t, std::vector<CellItem>> m_Cells;
+		std::unordered_map<Uid, Entry> m_Entries;
+		// Bounds of the occupied cells; limits the ring search. They may be too wide during update, but are tightened at its end.
+		CellCoordinates m_OccupiedMin{ emptyOccupiedMin() };
+		CellCoordinates m_OccupiedMax{ emptyOccupiedMax() };
+		bool m_OccupiedBoundsDirty = false;
+
+		[[nodiscard]] SpatialPosition position(const TComponent& component) const
+		{
+			return std::invoke(m_Projection, component);
+		}
+
+		[[nodiscard]] static float squaredDistance(const SpatialPosition& lhs, const SpatialPosition& rhs) noexcept
+		{
+			const auto x = lhs[0] - rhs[0];
+			const auto y = lhs[1] - rhs[1];
+			const auto z = lhs[2] - rhs[2];
+			return x * x + y * y + z * z;
+		}
+
+		[[nodiscard]] static bool contains(const SpatialPosition& min, const SpatialPosition& max, const SpatialPosition& position) noexcept
+		{
+			return min[0] <= position[0] && position[0] <= max[0] &&
+					min[1] <= position[1] && position[1] <= max[1] &&
+					min[2] <= position[2] && position[2] <= max[2];
+		}
+
+		[[nodiscard]] CellCoordinates cellCoordinates(const SpatialPosition& position) const noexcept
+		{
+			return {
+				static_cast<std::int64_t>(std::floor(position[0] * m_InverseCellSize)),
+				static_cast<std::int64_t>(std::floor(position[1] * m_InverseCellSize)),
+				static_cast<std::int64_t>(std::floor(position[2] * m_InverseCellSize))
+			};
+		}
+
+		// amount of cells per axis, after which keys repeat
+		static constexpr std::uint64_t cellKeyPeriod = std::uint64_t{ 1 } << 21;
+
+		// Packs 21 bits per axis. Far away cells may share a key, which costs some additional distance checks, but never results in wrong answers.
+		[[nodiscard]] static std::uint64_t cellKey(const CellCoordinates& coordinates) noexcept
+		{
+			constexpr std::uint64_t mask = cellKeyPeriod - 1u;
+			return (static_cast<std::uint64_t>(coordinates[0]) & mask) << 42 |
+					(static_cast<std::uint64_t>(coordinates[1]) & mask) << 21 |
+					(static_cast<std::uint64_t>(coordinates[2]) & mask);
+		}
+
+		// Visits the occupied cells, whose Chebyshev distance to the center equals ring.
+		template <class TCellAction>
+		void forEachCellOnRing(const CellCoordinates& center, std::int64_t ring, TCellAction action) const
+		{
+			auto visit = [&](std::int64_t x, std::int64_t y, std::int64_t z)
+			{
+				if (auto itr = m_Cells.find(cellKey({ x, y, z })); itr != std::end(m_Cells))
+					action(itr->second);
+			};
+
+			// cells outside of the occupied bounds are guaranteed to be empty
+			std::array<std::int64_t, 3> first{};
+			std::array<std::int64_t, 3> last{};
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				first[axis] = std::max(center[axis] - ring, m_OccupiedMin[axis]);
+				last[axis] = std::min(center[axis] + ring, m_OccupiedMax[axis]);
+			}
+
+			for (auto x = first[0]; x <= last[0]; ++x)
+			{
+				for (auto y = first[1]; y <= last[1]; ++y)
+				{
+					if (std::abs(x - center[0]) == ring || std::abs(y - center[1]) == ring)
+					{
+						for (auto z = first[2]; z <= last[2]; ++z)
+							visit(x, y, z);
+					}
+					else
+					{
+						// cells inside the shell have been visited by previous rings, thus only the outer layers of z are left
+						if (first[2] == center[2] - ring)
+							visit(x, y, first[2]);
+						if (last[2] == center[2] + ring && 0 < ring)
+							visit(x, y, last[2]);
+					}
+				}
+			}
+		}
+
+		void insert(Entity& entity)
+		{
+			auto handle = entity.componentHandle<const TComponent>();
+			if (!handle || m_Entries.contains(entity.uid()))
+				return;
+
+			const auto pos = position(*handle);
+			const auto coordinates = cellCoordinates(pos);
+			const auto cell = cellKey(coordinates);
+			auto& items = m_Cells[cell];
+			items.push_back({ pos, entity.uid() });
+			m_Entries.emplace(entity.uid(), Entry{ cell, std::size(items) - 1u, handle });
+			extendOccupiedBounds(coordinates);
+		}
+
+		void move(Uid uid, Entry& entry, const SpatialPosition& newPosition)
+		{
+			const auto coordinates = cellCoordinates(newPosition);
+			const auto cell = cellKey(coordinates);
+			if (cell == entry.cell)
+			{
+				m_Cells.find(cell)->second[entry.slot].position = newPosition;
+				return;
+			}
+
+			auto& items = m_Cells[cell];
+			items.push_back({ newPosition, uid });
+			removeFromCell(entry);
+			entry.cell = cell;
+			entry.slot = std::size(items) - 1u;
+			extendOccupiedBounds(coordinates);
+		}
+
+		void erase(Uid uid) noexcept
+		{
+			if (auto itr = m_Entries.find(uid); itr != std::end(m_Entries))
+			{
+				removeFromCell(itr->second);
+				m_Entries.erase(itr);
+			}
+		}
+
+		void removeFromCell(const Entry& entry) noexcept
+		{
+			auto& items = m_Cells.find(entry.cell)->second;
+			if (isOnOccupiedBounds(cellCoordinates(items[entry.slot].position)))
+				m_OccupiedBoundsDirty = true;
+
+			if (entry.slot + 1u != std::size(items))
+			{
+				items[entry.slot] = items.back();
+				m_Entries.find(items[entry.slot].uid)->second.slot = entry.slot;
+			}
+			items.pop_back();
+		}
+
+		void extendOccupiedBounds(const CellCoordinates& coordinates) noexcept
+		{
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				m_OccupiedMin[axis] = std::min(m_OccupiedMin[axis], coordinates[axis]);
+				m_OccupiedMax[axis] = std::max(m_OccupiedMax[axis], coordinates[axis]);
+			}
+		}
+
+		[[nodiscard]] bool isOnOccupiedBounds(const CellCoordinates& coordinates) const noexcept
+		{
+			for (std::size_t axis = 0; axis < 3; ++axis)
+			{
+				if (coordinates[axis] == m_OccupiedMin[axis] || coordinates[axis] == m_OccupiedMax[axis])
+					return true;
+			}
+			return false;
+		}
+
+		// Only required after an Entity left a cell on the bounds, thus Entities moving inside the bounds never trigger this.
+		void recalculateOccupiedBounds() noexcept
+		{
+			m_OccupiedMin = emptyOccupiedMin();
+			m_OccupiedMax = emptyOccupiedMax();
+			for (const auto& [key, items] : m_Cells)
+			{
+				// cells with different coordinates may share a key, thus each item has to be checked
+				for (const auto& item : items)
+					extendOccupiedBounds(cellCoordinates(item.position));
+			}
+			m_OccupiedBoundsDirty = false;
+		}
+
+		[[nodiscard]] static constexpr CellCoordinates emptyOccupiedMin() noexcept
+		{
+			constexpr auto max = std::numeric_limits<std::int64_t>::max();
+			return { max, max, max };
+		}
+
+		[[nodiscard]] static constexpr CellCoordinates emptyOccupiedMax() noexcept
+		{
+			constexpr auto min = std::numeric_limits<std::int64_t>::min();
+			return { min, min, min };
+		}
+	};
+}
+
+#endif
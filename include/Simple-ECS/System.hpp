@@ -8,16 +8,31 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <execution>
 #include <optional>
 #include <queue>
+#include <ranges>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <typeindex>
+#include <utility>
+#include <vector>
 
+#include "Concepts.hpp"
 #include "Defines.hpp"
+#include "DoubleBuffered.hpp"
 #include "EmptyCallable.hpp"
+#include "JobSystem.hpp"
+#include "Task.hpp"
 
 namespace secs
 {
@@ -43,6 +58,9 @@ namespace secs
 	 */
 	class ISystem
 	{
+		friend class Entity;
+		friend class World;
+
 	public:
 		constexpr ISystem(const ISystem&) noexcept = delete;
 		constexpr ISystem& operator =(const ISystem&) noexcept = delete;
@@ -60,57 +78,96 @@ namespace secs
 
 	protected:
 		constexpr ISystem() noexcept = default;
+
+	private:
+		// Component uids whose Entities changed their state; gathered by the World and flushed as one batch per System
+		std::vector<Uid> m_PendingStateChanges;
+		// Determined during System registration. Components of Systems without state change hooks will not be gathered at all.
+		bool m_ObservesEntityStates = true;
+
+		virtual void entityStatesChanged(EntityState state, std::span<const Uid> componentUids) = 0;
+		// destroys the Components moved out via ComponentRtti::retire; may run concurrently to the System's updates
+		virtual void destroyRetiredComponents() noexcept = 0;
+		// called by the World as the last step of postUpdate, after Entities have changed their states
+		virtual void endFrame() = 0;
 	};
 
 	template <class TComponent>
 	class SystemBase;
+
+	template <class T>
+		requires Component<std::remove_const_t<T>>
+	class ComponentHandle;
 }
 
 namespace secs::detail
 {
 	struct ComponentRtti
 	{
-		using DestroyFn_t = void(void*, Uid) noexcept;
-		using SetEntityFn_t = void(void*, Uid, Entity&) noexcept;
-		using EntityStateChangeFn_t = void(void*, Uid);
-		using FindComponentFn_t = const void*(const void*, Uid) noexcept;
+		using DestroyFn_t = void(ISystem&, Uid) noexcept;
+		using SetEntityFn_t = void(ISystem&, Uid, Entity&) noexcept;
+		using FindComponentFn_t = const void*(const ISystem&, Uid) noexcept;
+		using ReleaseFn_t = void(ISystem&, Uid) noexcept;
+		using RecycleFn_t = void(ISystem&, Uid, Entity&);
+		using RetireFn_t = void(ISystem&, Uid);
+		using SetEnabledFn_t = bool(ISystem&, Uid, bool) noexcept;
 
 		template <class TComponent>
-		static void destroyImpl(void* targetSystem, Uid componentUid) noexcept
+		static void destroyImpl(ISystem& targetSystem, Uid componentUid) noexcept
 		{
-			assert(targetSystem);
-			auto& system = *static_cast<SystemBase<TComponent>*>(targetSystem);
+			auto& system = static_cast<SystemBase<TComponent>&>(targetSystem);
 			system.destroyComponent(componentUid);
 		}
 
 		template <class TComponent>
-		static void setEntityImpl(void* targetSystem, Uid componentUid, Entity& entity) noexcept
+		static void setEntityImpl(ISystem& targetSystem, Uid componentUid, Entity& entity) noexcept
 		{
-			assert(targetSystem);
-			auto& system = *static_cast<SystemBase<TComponent>*>(targetSystem);
+			auto& system = static_cast<SystemBase<TComponent>&>(targetSystem);
 			system.setComponentEntity(componentUid, entity);
 		}
 
 		template <class TComponent>
-		static void entityStateChangedImpl(void* targetSystem, Uid componentUid)
+		static const void* findComponentImpl(const ISystem& targetSystem, Uid componentUid) noexcept
 		{
-			assert(targetSystem);
-			auto& system = *static_cast<SystemBase<TComponent>*>(targetSystem);
-			system.entityStateChanged(componentUid);
+			auto& system = static_cast<const SystemBase<TComponent>&>(targetSystem);
+			return static_cast<const void*>(system.findComponent(componentUid));
 		}
 
 		template <class TComponent>
-		static const void* findComponentImpl(const void* targetSystem, Uid componentUid) noexcept
+		static bool setEnabledImpl(ISystem& targetSystem, Uid componentUid, bool enabled) noexcept
 		{
-			assert(targetSystem);
-			auto& system = *static_cast<const SystemBase<TComponent>*>(targetSystem);
-			return static_cast<const void*>(system.findComponent(componentUid));
+			auto& system = static_cast<SystemBase<TComponent>&>(targetSystem);
+			return system.setComponentEnabled(componentUid, enabled);
+		}
+
+		template <class TComponent>
+		static void releaseImpl(ISystem& targetSystem, Uid componentUid) noexcept
+		{
+			auto& system = static_cast<SystemBase<TComponent>&>(targetSystem);
+			system.releaseComponent(componentUid);
+		}
+
+		template <class TComponent>
+		static void recycleImpl(ISystem& targetSystem, Uid componentUid, Entity& entity)
+		{
+			auto& system = static_cast<SystemBase<TComponent>&>(targetSystem);
+			system.recycleComponent(componentUid, entity);
+		}
+
+		template <class TComponent>
+		static void retireImpl(ISystem& targetSystem, Uid componentUid)
+		{
+			auto& system = static_cast<SystemBase<TComponent>&>(targetSystem);
+			system.retireComponent(componentUid);
 		}
 
 		DestroyFn_t* destroy;
 		SetEntityFn_t* setEntity;
-		EntityStateChangeFn_t* entityStateChanged;
 		FindComponentFn_t* findComponent;
+		ReleaseFn_t* release;
+		RecycleFn_t* recycle;
+		RetireFn_t* retire;
+		SetEnabledFn_t* setEnabled;
 	};
 
 	template <class TComponent>
@@ -118,22 +175,63 @@ namespace secs::detail
 	{
 		&ComponentRtti::destroyImpl<TComponent>,
 		&ComponentRtti::setEntityImpl<TComponent>,
-		&ComponentRtti::entityStateChangedImpl<TComponent>,
-		&ComponentRtti::findComponentImpl<TComponent>
+		&ComponentRtti::findComponentImpl<TComponent>,
+		&ComponentRtti::releaseImpl<TComponent>,
+		&ComponentRtti::recycleImpl<TComponent>,
+		&ComponentRtti::retireImpl<TComponent>,
+		&ComponentRtti::setEnabledImpl<TComponent>
 	};
 
 	struct ComponentStorageInfo
 	{
-		void* systemPtr = nullptr;
+		ISystem* system = nullptr;
 		Uid componentUid = 0;
 		std::type_index componentTypeIndex{ typeid(void) };
 		const ComponentRtti* rtti = nullptr;
+		bool observesEntityStates = true;
 	};
 
 	[[nodiscard]] inline bool isValid(const ComponentStorageInfo& info) noexcept
 	{
-		return info.systemPtr != nullptr && info.componentUid != 0 && info.componentTypeIndex != typeid(void) && info.rtti != nullptr;
+		return info.system != nullptr && info.componentUid != 0 && info.componentTypeIndex != typeid(void) && info.rtti != nullptr;
 	}
+
+	// The const iteration overloads take part in the overload resolution of non-const calls, too. Checking the mutable signature first avoids
+	// instantiating generic lambdas, which modify their argument, with a const argument.
+	template <class TAction, class TComponent>
+	concept ComponentReader = std::invocable<TAction&, Entity&, TComponent&> || std::invocable<TAction&, Entity&, const TComponent&>;
+
+	// std::atomic is neither copyable nor movable, but Systems have to be move constructible
+	class VersionCounter
+	{
+	public:
+		VersionCounter() noexcept = default;
+
+		VersionCounter(const VersionCounter& other) noexcept :
+			m_Value{ other.load() }
+		{
+		}
+
+		VersionCounter& operator =(const VersionCounter& other) noexcept
+		{
+			m_Value.store(other.load(), std::memory_order_relaxed);
+			return *this;
+		}
+
+		[[nodiscard]] std::uint64_t load() const noexcept
+		{
+			return m_Value.load(std::memory_order_relaxed);
+		}
+
+		// returns the previous value
+		std::uint64_t increment() noexcept
+		{
+			return m_Value.fetch_add(1, std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<std::uint64_t> m_Value{ 1 };
+	};
 }
 
 namespace secs
@@ -144,6 +242,9 @@ namespace secs
 	 * This is the class you should inherit from, when you are about to create a custom System for a corresponding Component type.
 	 * There are some virtual member functions you could override to tweak the behaviour of your Systems.
 	 * Each System type should only instantiated once during the runtime of your program.
+	 *
+	 * Components of disabled Entities (see Entity::setEnabled) are kept in their slots, but are not treated as active, thus they are skipped by
+	 * size, the views and each of the forEachComponent variants without any per Component check. They are still accessible via their uid.
 	 * \tparam TComponent The associated Component type.
 	 */
 	template <class TComponent>
@@ -154,11 +255,24 @@ namespace secs
 	private:
 		friend class World;
 		friend struct detail::ComponentRtti;
+		template <class, class>
+		friend class Query;
+		template <class>
+		friend class Group;
+		template <class T>
+			requires Component<std::remove_const_t<T>>
+		friend class ComponentHandle;
 
 		struct ComponentInfo
 		{
 			Entity* entity;
 			TComponent component;
+			// position in m_ActiveComponents; only valid while active
+			std::size_t activeIndex = 0;
+			// change version of the latest mutable access
+			std::uint64_t version = 0;
+			// unique per activation; used for detecting stale ComponentHandles
+			std::uint64_t generation = 0;
 		};
 
 	public:
@@ -167,6 +281,17 @@ namespace secs
 		 */
 		using ComponentType = TComponent;
 
+		/**
+		 * \brief Component object and its associated Entity
+		 *
+		 * Elements of this type will be passed as a batch to derivedEntityStatesChanged.
+		 */
+		struct ComponentEntityPair
+		{
+			TComponent& component;
+			Entity& entity;
+		};
+
 		SystemBase(const SystemBase&) = delete;
 		SystemBase& operator =(const SystemBase&) = delete;
 
@@ -192,7 +317,7 @@ namespace secs
 		 */
 		[[nodiscard]] constexpr bool hasComponent(Uid uid) const noexcept
 		{
-			return 0u < uid && uid <= std::size(m_Components) && m_Components[uid - 1u];
+			return 0u < uid && uid <= std::size(m_Components) && isActive(m_Components[uid - 1u]);
 		}
 
 		/**
@@ -204,7 +329,7 @@ namespace secs
 		{
 			if (0u < uid && uid <= std::size(m_Components))
 			{
-				if (auto& info = m_Components[uid - 1u])
+				if (auto& info = m_Components[uid - 1u]; isActive(info))
 					return &info->component;
 			}
 			return nullptr;
@@ -212,12 +337,46 @@ namespace secs
 
 		/**
 		 * \brief Queries for a Component object
+		 *
+		 * This counts as mutable access, thus the Component will be reported as changed.
 		 * \param uid Uid of the Component object.
 		 * \return pointer to the stored Component object or nullptr if not valid.
 		 */
 		[[nodiscard]] constexpr TComponent* findComponent(Uid uid) noexcept
 		{
-			return const_cast<TComponent*>(std::as_const(*this).findComponent(uid));
+			if (0u < uid && uid <= std::size(m_Components))
+			{
+				if (auto& info = m_Components[uid - 1u]; isActive(info))
+				{
+					markChanged(*info);
+					return &info->component;
+				}
+			}
+			return nullptr;
+		}
+
+		/**
+		 * \brief Creates a handle for a Component object
+		 * \param uid Uid of the Component object.
+		 * \return Returns a handle to the Component object or an invalid handle if not valid.
+		 */
+		[[nodiscard]] ComponentHandle<const TComponent> componentHandle(Uid uid) const noexcept
+		{
+			if (hasComponent(uid))
+				return { *this, uid, m_Components[uid - 1u]->generation };
+			return {};
+		}
+
+		/**
+		 * \brief Creates a handle for a Component object
+		 * \param uid Uid of the Component object.
+		 * \return Returns a handle to the Component object or an invalid handle if not valid.
+		 */
+		[[nodiscard]] ComponentHandle<TComponent> componentHandle(Uid uid) noexcept
+		{
+			if (hasComponent(uid))
+				return { *this, uid, m_Components[uid - 1u]->generation };
+			return {};
 		}
 
 		/**
@@ -238,13 +397,18 @@ namespace secs
 
 		/**
 		 * \brief Queries for a Component object
+		 *
+		 * This counts as mutable access, thus the Component will be reported as changed.
 		 * \param uid Uid of the Component object.
 		 * \throws SystemError if the Component object at uid is not valid.
 		 * \return Reference to the stored Component object.
 		 */
 		[[nodiscard]] constexpr TComponent& component(Uid uid)
 		{
-			return const_cast<TComponent&>(std::as_const(*this).component(uid));
+			if (auto* component = findComponent(uid))
+				return *component;
+			using namespace std::string_literals;
+			throw SystemError("System: \""s + typeid(*this).name() + "\" Component uid: " + std::to_string(uid) + " not found.");
 		}
 
 		/**
@@ -253,7 +417,7 @@ namespace secs
 		 */
 		[[nodiscard]] constexpr std::size_t size() const noexcept
 		{
-			return m_ComponentCount;
+			return m_EnabledCount;
 		}
 
 		/**
@@ -262,7 +426,102 @@ namespace secs
 		 */
 		[[nodiscard]] constexpr bool empty() const noexcept
 		{
-			return m_ComponentCount == 0;
+			return m_EnabledCount == 0;
+		}
+
+		/**
+		 * \brief View over all active Components
+		 *
+		 * The returned view is a sized random access range, thus it can directly be used with range algorithms and, via its iterators, with
+		 * the parallel algorithms of the standard library. The n-th element of this view and of the view returned by entities() belong together.
+		 * Dereferencing an element counts as mutable access, thus the Component will be reported as changed. Use the const overload, e.g. via
+		 * std::as_const(*this).components(), for reading without being reported.
+		 * \remark The view and its iterators become invalid when Components are created or destroyed. Iterators must not outlive their view object.
+		 * \return Returns a view of references to the active Component objects.
+		 */
+		[[nodiscard]] auto components() noexcept
+		{
+			return enabledComponents() | std::views::transform(
+															[this](ComponentInfo* info) -> TComponent&
+															{
+																markChanged(*info);
+																return info->component;
+															}
+															);
+		}
+
+		/**
+		 * \brief View over all active Components
+		 *
+		 * The returned view is a sized random access range, thus it can directly be used with range algorithms and, via its iterators, with
+		 * the parallel algorithms of the standard library. The n-th element of this view and of the view returned by entities() belong together.
+		 * \remark The view and its iterators become invalid when Components are created or destroyed. Iterators must not outlive their view object.
+		 * \return Returns a view of const references to the active Component objects.
+		 */
+		[[nodiscard]] auto components() const noexcept
+		{
+			return enabledComponents() | std::views::transform([](const ComponentInfo* info) -> const TComponent& { return info->component; });
+		}
+
+		/**
+		 * \brief View over the Entities of all active Components
+		 *
+		 * The n-th element of this view and of the view returned by components() belong together.
+		 * \remark The view and its iterators become invalid when Components are created or destroyed. Iterators must not outlive their view object.
+		 * \return Returns a sized random access view of references to the associated Entities.
+		 */
+		[[nodiscard]] auto entities() noexcept
+		{
+			return enabledComponents() | std::views::transform([](const ComponentInfo* info) -> Entity& { return *info->entity; });
+		}
+
+		/**
+		 * \brief View over the Entities of all active Components
+		 *
+		 * The n-th element of this view and of the view returned by components() belong together.
+		 * \remark The view and its iterators become invalid when Components are created or destroyed. Iterators must not outlive their view object.
+		 * \return Returns a sized random access view of const references to the associated Entities.
+		 */
+		[[nodiscard]] auto entities() const noexcept
+		{
+			return enabledComponents() | std::views::transform([](const ComponentInfo* info) -> const Entity& { return *info->entity; });
+		}
+
+		/**
+		 * \brief Current change version
+		 *
+		 * Each mutable access to a Component via its System (non-const findComponent, component, components and forEachComponent overloads, as
+		 * well as the state change hooks), via a mutable ComponentHandle, or via non-const Component types of Views, Queries and Groups stamps it
+		 * with the current change version. Creating a Component also counts as change. Accesses via Entity::findComponent and Entity::component
+		 * are never stamped, thus Systems, which only declared read access to a Component type, never write to its storage.
+		 * \return Returns the version, with which Components are currently stamped.
+		 */
+		[[nodiscard]] std::uint64_t changeVersion() const noexcept
+		{
+			return m_ChangeVersion.load();
+		}
+
+		/**
+		 * \brief Executes action on each active Component, which changed since the given version
+		 *
+		 * Each call advances the change version, thus Components which are changed afterwards receive a greater version. Pass the returned
+		 * version to the next call to receive each change exactly once. Multiple observers may track changes independently, each with its own
+		 * version. Mutable accesses must not happen concurrently to this call.
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param sinceVersion Components stamped with a greater version will be visited. Pass 0 to visit each active Component.
+		 * \param action Invokable object.
+		 * \return Returns the version to be passed to the next call.
+		 */
+		template <std::invocable<Entity&, const TComponent&> TComponentAction>
+		std::uint64_t forEachChangedComponent(std::uint64_t sinceVersion, TComponentAction action) const
+		{
+			const auto version = m_ChangeVersion.increment();
+			for (const auto* info : enabledComponents())
+			{
+				if (sinceVersion < info->version)
+					action(*info->entity, std::as_const(info->component));
+			}
+			return version;
 		}
 
 		/**
@@ -293,6 +552,24 @@ namespace secs
 		{
 		}
 
+		/**
+		 * \brief Checks whether a derived System overrides any of the state change hooks
+		 *
+		 * The World skips Systems without overrides while Entities change their states. An override declared as private or protected member of
+		 * TDerived is not accessible from here, which also results in true.
+		 * \tparam TDerived The derived System type.
+		 * \return Returns false if TDerived inherits both hooks unchanged.
+		 */
+		template <class TDerived>
+		[[nodiscard]] static consteval bool observesEntityStates() noexcept
+		{
+			return !requires
+			{
+				requires std::same_as<decltype(&TDerived::derivedEntityStateChanged), decltype(&SystemBase::derivedEntityStateChanged)>;
+				requires std::same_as<decltype(&TDerived::derivedEntityStatesChanged), decltype(&SystemBase::derivedEntityStatesChanged)>;
+			};
+		}
+
 	protected:
 		/**
 		 * \brief Protected default Constructor
@@ -303,11 +580,81 @@ namespace secs
 		 * \brief Entity state changed
 		 *
 		 * This function will be called when an Component associated Entity changed its state. It may be overridden.
+		 * \remark If a System overrides neither this function nor derivedEntityStatesChanged, its Components will be completely excluded
+		 * from the state change dispatching.
 		 */
 		virtual void derivedEntityStateChanged(TComponent& component, Entity& entity)
 		{
 		}
 
+		/**
+		 * \brief Entity states changed
+		 *
+		 * The World gathers all state transitions of a postUpdate step and notifies each System exactly once per step with all of its
+		 * affected Components. The default implementation calls derivedEntityStateChanged for each element. Override this function if the
+		 * transitions should be processed as a whole.
+		 * \param state The state each of the associated Entities changed into.
+		 * \param changes Components and their associated Entities.
+		 */
+		virtual void derivedEntityStatesChanged([[maybe_unused]] EntityState state, std::span<const ComponentEntityPair> changes)
+		{
+			for (auto& [component, entity] : changes)
+				derivedEntityStateChanged(component, entity);
+		}
+
+		/**
+		 * \brief JobSystem of the World
+		 *
+		 * Systems should use this JobSystem for spawning parallel work instead of maintaining their own threads.
+		 * \throws SystemError if the System has not been registered at a World yet.
+		 * \return Reference to the JobSystem of the World this System is registered at.
+		 */
+		[[nodiscard]] JobSystem& jobSystem() const
+		{
+			if (m_JobSystem)
+				return *m_JobSystem;
+			using namespace std::string_literals;
+			throw SystemError("System: \""s + typeid(*this).name() + "\" is not registered at a World.");
+		}
+
+		/**
+		 * \brief Index of the current frame
+		 * \throws SystemError if the System has not been registered at a World yet.
+		 * \return Returns the frame index of the World this System is registered at.
+		 */
+		[[nodiscard]] std::uint64_t frameIndex() const
+		{
+			if (m_FrameIndex)
+				return *m_FrameIndex;
+			using namespace std::string_literals;
+			throw SystemError("System: \""s + typeid(*this).name() + "\" is not registered at a World.");
+		}
+
+		/**
+		 * \brief Starts a Task
+		 *
+		 * The Task will be resumed by the World this System is registered at. See \ref Task for details.
+		 * \throws SystemError if the System has not been registered at a World yet.
+		 * \param task The Task to be started.
+		 */
+		void startTask(Task task) const
+		{
+			taskScheduler().start(std::move(task));
+		}
+
+		/**
+		 * \brief Starts a Task which is bound to an Entity
+		 *
+		 * The Task will be resumed by the World this System is registered at, but will be destroyed instead as soon as the Entity is torn down.
+		 * \throws SystemError if the System has not been registered at a World yet.
+		 * \param entity The Entity the Task is bound to.
+		 * \param task The Task to be started.
+		 */
+		void startTask(const Entity& entity, Task task) const
+		{
+			taskScheduler().start(std::move(task), entityUid(entity));
+		}
+
 		/**
 		 * \brief Executes action on each active Component
 		 * \tparam TComponentAction Invokable object with specific signature.
@@ -316,56 +663,416 @@ namespace secs
 		template <std::invocable<Entity&, TComponent&> TComponentAction>
 		void forEachComponent(TComponentAction action)
 		{
-			for (auto& info : m_Components)
+			for (auto* info : enabledComponents())
+			{
+				markChanged(*info);
+				action(*info->entity, info->component);
+			}
+		}
+
+		/**
+		 * \brief Executes action on each active Component without reporting them as changed
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param action Invokable object, which receives const references to the Components.
+		 */
+		template <detail::ComponentReader<TComponent> TComponentAction>
+		void forEachComponent(TComponentAction action) const
+		{
+			for (const auto* info : enabledComponents())
+				action(*info->entity, std::as_const(info->component));
+		}
+
+		/**
+		 * \brief Executes action on each active Component with the given execution policy
+		 *
+		 * This simply forwards to std::for_each, thus the standard library decides how the Components are processed.
+		 * \tparam TExecutionPolicy Standard execution policy type (e.g. std::execution::par or std::execution::par_unseq).
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param policy The execution policy.
+		 * \param action Invokable object. It must satisfy the requirements of the passed policy.
+		 */
+		template <class TExecutionPolicy, std::invocable<Entity&, TComponent&> TComponentAction>
+			requires std::is_execution_policy_v<std::remove_cvref_t<TExecutionPolicy>>
+		void forEachComponent(TExecutionPolicy&& policy, TComponentAction action)
+		{
+			const auto infos = enabledComponents();
+			std::for_each(
+						std::forward<TExecutionPolicy>(policy),
+						std::begin(infos),
+						std::end(infos),
+						[this, &action](ComponentInfo* info)
+						{
+							markChanged(*info);
+							action(*info->entity, info->component);
+						}
+						);
+		}
+
+		/**
+		 * \brief Executes action on each active Component with the given execution policy without reporting them as changed
+		 * \tparam TExecutionPolicy Standard execution policy type (e.g. std::execution::par or std::execution::par_unseq).
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param policy The execution policy.
+		 * \param action Invokable object, which receives const references to the Components. It must satisfy the requirements of the passed policy.
+		 */
+		template <class TExecutionPolicy, detail::ComponentReader<TComponent> TComponentAction>
+			requires std::is_execution_policy_v<std::remove_cvref_t<TExecutionPolicy>>
+		void forEachComponent(TExecutionPolicy&& policy, TComponentAction action) const
+		{
+			const auto infos = enabledComponents();
+			std::for_each(
+						std::forward<TExecutionPolicy>(policy),
+						std::begin(infos),
+						std::end(infos),
+						[&action](const ComponentInfo* info) { action(*info->entity, std::as_const(info->component)); }
+						);
+		}
+
+		/**
+		 * \brief Executes action on each active Component of one bucket
+		 *
+		 * Entities are distributed over bucketCount buckets by their uid, thus each Entity stays in the same bucket during its whole
+		 * lifetime. Processing a different bucket each frame, e.g. frameIndex() % bucketCount, staggers expensive work across multiple frames.
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param bucket Index of the bucket to be processed. Must be less than bucketCount.
+		 * \param bucketCount Total amount of buckets. Must be greater than zero.
+		 * \param action Invokable object.
+		 */
+		template <std::invocable<Entity&, TComponent&> TComponentAction>
+		void forEachComponentInBucket(std::size_t bucket, std::size_t bucketCount, TComponentAction action)
+		{
+			assert(bucket < bucketCount);
+			for (auto* info : enabledComponents())
 			{
-				if (info)
+				if (entityUid(*info->entity) % bucketCount == bucket)
 				{
-					assert(info->entity);
+					markChanged(*info);
 					action(*info->entity, info->component);
 				}
 			}
 		}
 
+		/**
+		 * \brief Executes action on each active Component of one bucket without reporting them as changed
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param bucket Index of the bucket to be processed. Must be less than bucketCount.
+		 * \param bucketCount Total amount of buckets. Must be greater than zero.
+		 * \param action Invokable object, which receives const references to the Components.
+		 */
+		template <detail::ComponentReader<TComponent> TComponentAction>
+		void forEachComponentInBucket(std::size_t bucket, std::size_t bucketCount, TComponentAction action) const
+		{
+			assert(bucket < bucketCount);
+			for (const auto* info : enabledComponents())
+			{
+				if (entityUid(*info->entity) % bucketCount == bucket)
+					action(*info->entity, std::as_const(info->component));
+			}
+		}
+
+		/**
+		 * \brief Executes action on each active Component in parallel
+		 *
+		 * The active Components will be recursively split into halves until each part contains at most grainSize elements. Split off parts are
+		 * pushed onto the queue of the executing thread, where idle workers of the World's JobSystem may steal them. Thus the load stays
+		 * balanced, even if the costs per Component vary. The calling thread takes part in the execution and
+		 * returns after each Component has been processed. If the System has not been registered at a World with worker threads, this behaves
+		 * like forEachComponent.
+		 * \remark The action will be invoked concurrently for different Components and must not throw.
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param action Invokable object.
+		 * \param grainSize Maximal amount of Components which will be processed as one unit.
+		 */
+		template <std::invocable<Entity&, TComponent&> TComponentAction>
+		void parallelForEachComponent(TComponentAction action, std::size_t grainSize = 256)
+		{
+			parallelForEachInfo(
+								enabledComponents(),
+								[this, &action](ComponentInfo& info)
+								{
+									markChanged(info);
+									action(*info.entity, info.component);
+								},
+								grainSize
+								);
+		}
+
+		/**
+		 * \brief Executes action on each active Component in parallel without reporting them as changed
+		 * \remark The action will be invoked concurrently for different Components and must not throw.
+		 * \tparam TComponentAction Invokable object with specific signature.
+		 * \param action Invokable object, which receives const references to the Components.
+		 * \param grainSize Maximal amount of Components which will be processed as one unit.
+		 */
+		template <detail::ComponentReader<TComponent> TComponentAction>
+		void parallelForEachComponent(TComponentAction action, std::size_t grainSize = 256) const
+		{
+			parallelForEachInfo(
+								enabledComponents(),
+								[&action](const ComponentInfo& info) { action(*info.entity, std::as_const(info.component)); },
+								grainSize
+								);
+		}
+
 	private:
-		std::size_t m_ComponentCount = 0;
+		template <class TInfoAction>
+		void parallelForEachInfo(std::span<ComponentInfo* const> infos, TInfoAction action, std::size_t grainSize) const
+		{
+			grainSize = std::max<std::size_t>(grainSize, 1);
+			if (!m_JobSystem || m_JobSystem->workerCount() == 0 || std::size(infos) <= grainSize)
+			{
+				for (auto* info : infos)
+					action(*info);
+				return;
+			}
+
+			std::atomic<std::size_t> pendingRanges{ 1 };
+			auto processRange = [&](std::size_t first, std::size_t last, const auto& self) -> void
+			{
+				while (grainSize < last - first)
+				{
+					const auto middle = first + (last - first) / 2u;
+					++pendingRanges;
+					m_JobSystem->submit([middle, last, &self] { self(middle, last, self); });
+					last = middle;
+				}
+
+				for (; first != last; ++first)
+					action(*infos[first]);
+				--pendingRanges;
+			};
+
+			processRange(0, std::size(infos), processRange);
+			m_JobSystem->waitUntil([&pendingRanges] { return pendingRanges == 0; });
+		}
+
+		void markChanged(ComponentInfo& info) const noexcept
+		{
+			info.version = m_ChangeVersion.load();
+		}
+
+		// assigned during registration at a World
+		JobSystem* m_JobSystem = nullptr;
+		detail::TaskScheduler* m_TaskScheduler = nullptr;
+		const std::uint64_t* m_FrameIndex = nullptr;
 		std::deque<std::optional<ComponentInfo>> m_Components;
+		// Densely packed active Components in no particular order, except that the Components of enabled Entities precede the others.
+		// Capacity is kept in sync with the slot count, thus activation never allocates.
+		std::vector<ComponentInfo*> m_ActiveComponents;
+		std::size_t m_EnabledCount = 0;
+		// The first m_GroupSize active Components are sorted by the owning Group and must only be moved by it. This is always a prefix of the
+		// enabled partition.
+		std::size_t m_GroupSize = 0;
+		bool m_GroupOwned = false;
+		std::uint64_t m_NextGeneration = 1;
+		// Uids of destroyed Component slots. Capacity is kept in sync with the slot count, thus destroyComponent never allocates.
+		std::vector<Uid> m_FreeUids;
+		std::vector<ComponentEntityPair> m_StateChangeBuffer;
+		// Components of destroyed Entities, whose destruction is deferred to a job of the World
+		std::vector<TComponent> m_RetiredComponents;
+		mutable detail::VersionCounter m_ChangeVersion;
+
+		[[nodiscard]] detail::TaskScheduler& taskScheduler() const
+		{
+			if (m_TaskScheduler)
+				return *m_TaskScheduler;
+			using namespace std::string_literals;
+			throw SystemError("System: \""s + typeid(*this).name() + "\" is not registered at a World.");
+		}
+
+		// Entity is incomplete at this point
+		template <std::same_as<Entity> TEntity>
+		[[nodiscard]] static Uid entityUid(const TEntity& entity) noexcept
+		{
+			return entity.uid();
+		}
+
+		// Slots without an associated Entity are either just created or reserved by a recycled Entity. Both are treated as absent.
+		[[nodiscard]] static constexpr bool isActive(const std::optional<ComponentInfo>& info) noexcept
+		{
+			return info && info->entity;
+		}
 
 		template <class TComponentCreator = utils::EmptyCallable<TComponent>>
 		[[nodiscard]] Uid createComponent(TComponentCreator&& creator = TComponentCreator{})
 		{
-			if (auto itr = std::find(std::begin(m_Components), std::end(m_Components), std::nullopt);
-				itr != std::end(m_Components))
+			if (!std::empty(m_FreeUids))
 			{
-				itr->emplace(ComponentInfo{ nullptr, creator() });
-				++m_ComponentCount;
-				return { static_cast<Uid>(std::distance(std::begin(m_Components), itr)) + 1u };
+				const auto uid = m_FreeUids.back();
+				assert(!m_Components[uid - 1u]);
+				m_Components[uid - 1u].emplace(ComponentInfo{ nullptr, creator(), 0, m_ChangeVersion.load() });
+				m_FreeUids.pop_back();
+				return uid;
 			}
-			m_Components.emplace_back(ComponentInfo{ nullptr, creator() });
-			++m_ComponentCount;
+			reserveBookkeeping(std::size(m_Components) + 1u);
+			m_Components.emplace_back(ComponentInfo{ nullptr, creator(), 0, m_ChangeVersion.load() });
 			return static_cast<Uid>(std::size(m_Components));
 		}
 
+		// grows geometrically, because reserve itself may allocate exactly the requested capacity
+		void reserveBookkeeping(std::size_t slotCount)
+		{
+			if (m_FreeUids.capacity() < slotCount)
+				m_FreeUids.reserve(std::max(slotCount, 2u * m_FreeUids.capacity()));
+			if (m_ActiveComponents.capacity() < slotCount)
+				m_ActiveComponents.reserve(std::max(slotCount, 2u * m_ActiveComponents.capacity()));
+		}
+
+		// Appends empty slots, which will be used by the next created Components. The slot memory is touched by the calling thread.
+		void reserveComponentSlots(std::size_t count)
+		{
+			const auto firstUid = std::size(m_Components) + 1u;
+			reserveBookkeeping(std::size(m_Components) + count);
+			m_Components.resize(std::size(m_Components) + count);
+			// the lowest uid will be used first
+			for (auto uid = firstUid + count; firstUid < uid; --uid)
+				m_FreeUids.emplace_back(static_cast<Uid>(uid - 1u));
+		}
+
+		// Slots never shrink, thus uids of handles always refer to an existing slot.
+		[[nodiscard]] const TComponent* findComponent(Uid uid, std::uint64_t generation) const noexcept
+		{
+			assert(0u < uid && uid <= std::size(m_Components));
+			if (auto& info = m_Components[uid - 1u]; isActive(info) && info->generation == generation)
+				return &info->component;
+			return nullptr;
+		}
+
+		[[nodiscard]] TComponent* findComponent(Uid uid, std::uint64_t generation) noexcept
+		{
+			assert(0u < uid && uid <= std::size(m_Components));
+			if (auto& info = m_Components[uid - 1u]; isActive(info) && info->generation == generation)
+			{
+				markChanged(*info);
+				return &info->component;
+			}
+			return nullptr;
+		}
+
+		[[nodiscard]] std::span<ComponentInfo* const> enabledComponents() const noexcept
+		{
+			return { m_ActiveComponents.data(), m_EnabledCount };
+		}
+
+		void swapActiveComponents(std::size_t lhs, std::size_t rhs) noexcept
+		{
+			std::swap(m_ActiveComponents[lhs], m_ActiveComponents[rhs]);
+			m_ActiveComponents[lhs]->activeIndex = lhs;
+			m_ActiveComponents[rhs]->activeIndex = rhs;
+		}
+
 		void setComponentEntity(Uid uid, Entity& entity) noexcept
+		{
+			assert(0u < uid && uid <= std::size(m_Components) && m_Components[uid - 1u] && !m_Components[uid - 1u]->entity);
+			auto& info = *m_Components[uid - 1u];
+			info.entity = &entity;
+			info.generation = m_NextGeneration++;
+			info.activeIndex = std::size(m_ActiveComponents);
+			m_ActiveComponents.emplace_back(&info);
+			swapActiveComponents(info.activeIndex, m_EnabledCount++);
+		}
+
+		void deactivateComponent(ComponentInfo& info) noexcept
+		{
+			assert(info.entity && m_ActiveComponents[info.activeIndex] == &info);
+			assert(m_GroupSize <= info.activeIndex);
+			if (info.activeIndex < m_EnabledCount)
+				swapActiveComponents(info.activeIndex, --m_EnabledCount);
+			swapActiveComponents(info.activeIndex, std::size(m_ActiveComponents) - 1u);
+			m_ActiveComponents.pop_back();
+			info.entity = nullptr;
+		}
+
+		// moves the Component across the border between the enabled and disabled partition
+		// returns false, if the Component already was in the requested partition
+		bool setComponentEnabled(Uid uid, bool enabled) noexcept
 		{
 			assert(hasComponent(uid));
-			m_Components[uid - 1u]->entity = &entity;
+			auto& info = *m_Components[uid - 1u];
+			if (enabled && m_EnabledCount <= info.activeIndex)
+			{
+				swapActiveComponents(info.activeIndex, m_EnabledCount++);
+				// changes during the disabled period would have been missed otherwise
+				markChanged(info);
+				return true;
+			}
+			if (!enabled && info.activeIndex < m_EnabledCount)
+			{
+				assert(m_GroupSize <= info.activeIndex);
+				swapActiveComponents(info.activeIndex, --m_EnabledCount);
+				return true;
+			}
+			return false;
 		}
 
-		constexpr void destroyComponent(Uid uid) noexcept
+		void destroyComponent(Uid uid) noexcept
 		{
-			if (uid <= std::size(m_Components))
+			if (0u < uid && uid <= std::size(m_Components))
 			{
-				m_Components[uid - 1].reset();
-				--m_ComponentCount;
+				if (auto& info = m_Components[uid - 1u])
+				{
+					if (info->entity)
+						deactivateComponent(*info);
+					info.reset();
+					m_FreeUids.emplace_back(uid);
+				}
 			}
 		}
 
-		constexpr void entityStateChanged(Uid uid)
+		// Similar to destroyComponent, but moves the Component out instead of destructing it. The slot can be reused immediately.
+		void retireComponent(Uid uid)
 		{
-			assert(0u < uid && uid <= std::size(m_Components));
+			assert(0u < uid && uid <= std::size(m_Components) && m_Components[uid - 1u]);
 			auto& info = m_Components[uid - 1u];
-			assert(info && info->entity);
-			derivedEntityStateChanged(info->component, *info->entity);
+			m_RetiredComponents.emplace_back(std::move(info->component));
+			if (info->entity)
+				deactivateComponent(*info);
+			info.reset();
+			m_FreeUids.emplace_back(uid);
+		}
+
+		void destroyRetiredComponents() noexcept final
+		{
+			m_RetiredComponents.clear();
+		}
+
+		void endFrame() final
+		{
+			if constexpr (detail::IsDoubleBuffered<TComponent>::value)
+			{
+				// committing is no change on its own, because writing the next state has already been stamped
+				constexpr std::size_t grainSize = 1024;
+				parallelForEachInfo(m_ActiveComponents, [](ComponentInfo& info) { info.component.commit(); }, grainSize);
+			}
+		}
+
+		void releaseComponent(Uid uid) noexcept
+		{
+			assert(hasComponent(uid));
+			deactivateComponent(*m_Components[uid - 1u]);
+		}
+
+		void recycleComponent(Uid uid, Entity& entity)
+		{
+			assert(0u < uid && uid <= std::size(m_Components) && m_Components[uid - 1u] && !m_Components[uid - 1u]->entity);
+			m_Components[uid - 1u]->component = utils::EmptyCallable<TComponent>{}();
+			markChanged(*m_Components[uid - 1u]);
+			setComponentEntity(uid, entity);
+		}
+
+		void entityStatesChanged(EntityState state, std::span<const Uid> componentUids) final
+		{
+			m_StateChangeBuffer.clear();
+			m_StateChangeBuffer.reserve(std::size(componentUids));
+			for (auto uid : componentUids)
+			{
+				assert(0u < uid && uid <= std::size(m_Components));
+				auto& info = m_Components[uid - 1u];
+				assert(info && info->entity);
+				markChanged(*info);
+				m_StateChangeBuffer.emplace_back(info->component, *info->entity);
+			}
+			derivedEntityStatesChanged(state, m_StateChangeBuffer);
 		}
 	};
 }
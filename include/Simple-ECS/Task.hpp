@@ -0,0 +1,545 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_TASK_HPP
+#define SECS_TASK_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Defines.hpp"
+#include "JobSystem.hpp"
+
+namespace secs::detail
+{
+	/**
+	 * \brief Pool for coroutine frames
+	 *
+	 * Frames are grouped into size classes. Released frames are kept in an intrusive free list of their size class and will be reused by
+	 * the next frame of the same class, thus steady task creation does not hit the global allocator at all. Frames larger than the biggest
+	 * size class are allocated directly.
+	 */
+	class TaskFramePool
+	{
+	public:
+		static constexpr std::size_t granularity = 64;
+		static constexpr std::size_t sizeClassCount = 16;
+
+		TaskFramePool() = default;
+
+		TaskFramePool(const TaskFramePool&) = delete;
+		TaskFramePool& operator =(const TaskFramePool&) = delete;
+		TaskFramePool(TaskFramePool&&) = delete;
+		TaskFramePool& operator =(TaskFramePool&&) = delete;
+
+		~TaskFramePool() noexcept
+		{
+			for (auto* node : m_FreeLists)
+			{
+				while (node)
+					::operator delete(std::exchange(node, node->next));
+			}
+		}
+
+		[[nodiscard]] static TaskFramePool& instance() noexcept
+		{
+			static TaskFramePool pool;
+			return pool;
+		}
+
+		[[nodiscard]] void* allocate(std::size_t size)
+		{
+			const auto sizeClass = sizeClassOf(size);
+			if (sizeClassCount <= sizeClass)
+				return ::operator new(size);
+
+			{
+				std::scoped_lock lock{ m_Mx };
+				if (auto* node = m_FreeLists[sizeClass])
+				{
+					m_FreeLists[sizeClass] = node->next;
+					return node;
+				}
+			}
+			return ::operator new((sizeClass + 1) * granularity);
+		}
+
+		void deallocate(void* ptr, std::size_t size) noexcept
+		{
+			const auto sizeClass = sizeClassOf(size);
+			if (sizeClassCount <= sizeClass)
+			{
+				::operator delete(ptr);
+				return;
+			}
+
+			auto* node = static_cast<FreeNode*>(ptr);
+			std::scoped_lock lock{ m_Mx };
+			node->next = m_FreeLists[sizeClass];
+			m_FreeLists[sizeClass] = node;
+		}
+
+	private:
+		struct FreeNode
+		{
+			FreeNode* next;
+		};
+
+		std::mutex m_Mx;
+		std::array<FreeNode*, sizeClassCount> m_FreeLists{};
+
+		[[nodiscard]] static constexpr std::size_t sizeClassOf(std::size_t size) noexcept
+		{
+			return (std::max(size, sizeof(FreeNode)) - 1) / granularity;
+		}
+	};
+
+	class TaskScheduler;
+}
+
+namespace secs
+{
+	/**
+	 * \brief Awaitable which suspends a Task for the given amount of World updates
+	 */
+	struct WaitFrames
+	{
+		std::uint64_t count = 1;
+	};
+
+	/**
+	 * \brief Awaitable which suspends a Task until the accumulated update delta reached the given duration
+	 */
+	struct WaitTime
+	{
+		float duration = 0;
+	};
+
+	/**
+	 * \brief Suspends a Task until the next World update
+	 * \return Awaitable object.
+	 */
+	[[nodiscard]] constexpr WaitFrames nextFrame() noexcept
+	{
+		return {};
+	}
+
+	/**
+	 * \brief Suspends a Task for the given amount of World updates
+	 * \param count Amount of updates. Zero does not suspend at all.
+	 * \return Awaitable object.
+	 */
+	[[nodiscard]] constexpr WaitFrames frames(std::uint64_t count) noexcept
+	{
+		return { count };
+	}
+
+	/**
+	 * \brief Suspends a Task until the passed duration elapsed
+	 *
+	 * The duration is measured by the deltas passed to World::update, thus it is expressed in the same unit.
+	 * \param duration Duration to wait.
+	 * \return Awaitable object.
+	 */
+	[[nodiscard]] constexpr WaitTime delay(float duration) noexcept
+	{
+		return { duration };
+	}
+
+	/** \class Task
+	 * \brief Coroutine type, which will be resumed by the World during its update
+	 *
+	 * Tasks are C++20 coroutines which can co_await nextFrame(), frames(n), delay(duration) or a JobHandle. A Task does not start on its own;
+	 * it has to be handed over to World::startTask or SystemBase::startTask, which will resume it during the next World::update call after
+	 * each System has been updated. All Tasks are resumed on the thread calling World::update. Tasks may be bound to an Entity, in which case
+	 * they are destroyed during the postUpdate call, which tears that Entity down, thus their frames do not outlive the Entity. Bound Tasks, which
+	 * are waiting for a JobHandle, are destroyed as soon as the job finished instead, because the job may still refer to their frame.
+	 *
+	 * Coroutine frames are allocated from a pool, which reuses the memory of finished Tasks.
+	 * \remark Tasks must not throw. An exception leaving a Task results in std::terminate.
+	 */
+	class Task
+	{
+		friend class detail::TaskScheduler;
+
+	public:
+		struct promise_type;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		/**
+		 * \brief Promise type of Tasks
+		 *
+		 * Users do not need to interact with this type directly.
+		 */
+		struct promise_type
+		{
+			detail::TaskScheduler* scheduler = nullptr;
+			Uid entityUid = 0;
+
+			[[nodiscard]] static void* operator new(std::size_t size)
+			{
+				return detail::TaskFramePool::instance().allocate(size);
+			}
+
+			static void operator delete(void* ptr, std::size_t size) noexcept
+			{
+				detail::TaskFramePool::instance().deallocate(ptr, size);
+			}
+
+			[[nodiscard]] Task get_return_object() noexcept
+			{
+				return Task{ Handle::from_promise(*this) };
+			}
+
+			[[nodiscard]] std::suspend_always initial_suspend() const noexcept
+			{
+				return {};
+			}
+
+			// finished frames are destroyed by the scheduler
+			[[nodiscard]] std::suspend_always final_suspend() const noexcept
+			{
+				return {};
+			}
+
+			void return_void() const noexcept
+			{
+			}
+
+			[[noreturn]] void unhandled_exception() const noexcept
+			{
+				std::terminate();
+			}
+
+			[[nodiscard]] auto await_transform(WaitFrames wait) noexcept;
+			[[nodiscard]] auto await_transform(WaitTime wait) noexcept;
+			[[nodiscard]] auto await_transform(JobHandle job) noexcept;
+		};
+
+		Task(const Task&) = delete;
+		Task& operator =(const Task&) = delete;
+
+		/**
+		 * \brief Move Constructor
+		 */
+		Task(Task&& other) noexcept :
+			m_Handle{ std::exchange(other.m_Handle, nullptr) }
+		{
+		}
+
+		/**
+		 * \brief Move Assignment
+		 */
+		Task& operator =(Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				m_Handle = std::exchange(other.m_Handle, nullptr);
+			}
+			return *this;
+		}
+
+		/**
+		 * \brief Destructor
+		 *
+		 * Destroys the coroutine frame if the Task has not been started.
+		 */
+		~Task() noexcept
+		{
+			reset();
+		}
+
+	private:
+		Handle m_Handle;
+
+		explicit Task(Handle handle) noexcept :
+			m_Handle{ handle }
+		{
+		}
+
+		void reset() noexcept
+		{
+			if (m_Handle)
+				std::exchange(m_Handle, nullptr).destroy();
+		}
+	};
+}
+
+namespace secs::detail
+{
+	/**
+	 * \brief Owns all started Tasks of a World and resumes them
+	 *
+	 * Tasks which can be resumed immediately are stored in a ready queue, while Tasks waiting for a specific update or a point in time are stored in
+	 * min heaps, thus each update only touches the Tasks which actually become ready. Tasks waiting for jobs are polled once per update. The amount
+	 * of Tasks bound to each Entity is counted, thus cancelling only scans the Tasks if any of the torn down Entities has bound Tasks.
+	 * \remark start may be called from any thread. Everything else must be called from the thread which updates the World.
+	 */
+	class TaskScheduler
+	{
+	public:
+		TaskScheduler() = default;
+
+		TaskScheduler(const TaskScheduler&) = delete;
+		TaskScheduler& operator =(const TaskScheduler&) = delete;
+		TaskScheduler(TaskScheduler&&) = delete;
+		TaskScheduler& operator =(TaskScheduler&&) = delete;
+
+		~TaskScheduler() noexcept
+		{
+			for (auto handle : m_StartedTasks)
+				handle.destroy();
+			for (auto handle : m_ReadyTasks)
+				handle.destroy();
+			for (auto& entry : m_FrameWaits)
+				entry.handle.destroy();
+			for (auto& entry : m_TimeWaits)
+				entry.handle.destroy();
+			for (auto& entry : m_JobWaits)
+				entry.handle.destroy();
+		}
+
+		void start(Task task, Uid entityUid = 0)
+		{
+			assert(task.m_Handle);
+			auto handle = task.m_Handle;
+			handle.promise().scheduler = this;
+			handle.promise().entityUid = entityUid;
+
+			std::scoped_lock lock{ m_StartMx };
+			m_StartedTasks.reserve(std::size(m_StartedTasks) + 1u);
+			if (entityUid != 0)
+				++m_BoundTaskCounts[entityUid];
+			m_StartedTasks.emplace_back(handle);
+			task.m_Handle = nullptr;
+		}
+
+		// Destroys the Tasks bound to the passed Entity uids. Tasks waiting for a job are kept, because the job may still refer to their frame;
+		// those are destroyed by update as soon as the job finished.
+		template <class TUidRange>
+		void cancel(const TUidRange& entityUids)
+		{
+			std::scoped_lock lock{ m_StartMx };
+			if (std::empty(m_BoundTaskCounts))
+				return;
+
+			m_CancelledUids.clear();
+			for (const Uid uid : entityUids)
+			{
+				if (m_BoundTaskCounts.contains(uid))
+					m_CancelledUids.emplace(uid);
+			}
+			if (std::empty(m_CancelledUids))
+				return;
+
+			auto destroyCancelled = [this](Task::Handle handle)
+			{
+				if (!m_CancelledUids.contains(handle.promise().entityUid))
+					return false;
+
+				destroyUnlocked(handle);
+				return true;
+			};
+			std::erase_if(m_StartedTasks, destroyCancelled);
+			std::erase_if(m_ReadyTasks, destroyCancelled);
+			if (std::erase_if(m_FrameWaits, [&](const FrameWait& entry) { return destroyCancelled(entry.handle); }) != 0)
+				std::ranges::make_heap(m_FrameWaits, std::greater{}, &FrameWait::frame);
+			if (std::erase_if(m_TimeWaits, [&](const TimeWait& entry) { return destroyCancelled(entry.handle); }) != 0)
+				std::ranges::make_heap(m_TimeWaits, std::greater{}, &TimeWait::time);
+		}
+
+		[[nodiscard]] std::size_t taskCount() const noexcept
+		{
+			std::scoped_lock lock{ m_StartMx };
+			return std::size(m_StartedTasks) + std::size(m_ReadyTasks) + std::size(m_FrameWaits) + std::size(m_TimeWaits) +
+				std::size(m_JobWaits);
+		}
+
+		// TIsCancelled is queried with the uid of the bound Entity before a Task is resumed
+		template <class TIsCancelled>
+		void update(float delta, TIsCancelled isCancelled) noexcept
+		{
+			++m_Frame;
+			m_Time += delta;
+
+			{
+				std::scoped_lock lock{ m_StartMx };
+				m_ReadyTasks.insert(std::end(m_ReadyTasks), std::begin(m_StartedTasks), std::end(m_StartedTasks));
+				m_StartedTasks.clear();
+			}
+
+			while (!std::empty(m_FrameWaits) && m_FrameWaits.front().frame <= m_Frame)
+			{
+				std::ranges::pop_heap(m_FrameWaits, std::greater{}, &FrameWait::frame);
+				m_ReadyTasks.emplace_back(m_FrameWaits.back().handle);
+				m_FrameWaits.pop_back();
+			}
+
+			while (!std::empty(m_TimeWaits) && m_TimeWaits.front().time <= m_Time)
+			{
+				std::ranges::pop_heap(m_TimeWaits, std::greater{}, &TimeWait::time);
+				m_ReadyTasks.emplace_back(m_TimeWaits.back().handle);
+				m_TimeWaits.pop_back();
+			}
+
+			if (!std::empty(m_JobWaits))
+			{
+				auto remaining = std::ranges::partition(m_JobWaits, [](const JobWait& entry) { return !entry.job.finished(); });
+				for (auto& entry : remaining)
+					m_ReadyTasks.emplace_back(entry.handle);
+				m_JobWaits.erase(std::begin(remaining), std::end(remaining));
+			}
+
+			// Tasks which suspend again will be enqueued into the wait containers, thus the ready queue can be swapped out as a whole
+			std::swap(m_ReadyTasks, m_ResumingTasks);
+			for (auto handle : m_ResumingTasks)
+			{
+				if (const auto uid = handle.promise().entityUid; uid != 0 && isCancelled(uid))
+				{
+					destroy(handle);
+					continue;
+				}
+
+				handle.resume();
+				if (handle.done())
+					destroy(handle);
+			}
+			m_ResumingTasks.clear();
+		}
+
+		void waitFrames(Task::Handle handle, std::uint64_t count)
+		{
+			m_FrameWaits.push_back({ m_Frame + count, handle });
+			std::ranges::push_heap(m_FrameWaits, std::greater{}, &FrameWait::frame);
+		}
+
+		void waitTime(Task::Handle handle, float duration)
+		{
+			m_TimeWaits.push_back({ m_Time + duration, handle });
+			std::ranges::push_heap(m_TimeWaits, std::greater{}, &TimeWait::time);
+		}
+
+		void waitJob(Task::Handle handle, JobHandle job)
+		{
+			m_JobWaits.push_back({ std::move(job), handle });
+		}
+
+	private:
+		struct FrameWait
+		{
+			std::uint64_t frame;
+			Task::Handle handle;
+		};
+
+		struct TimeWait
+		{
+			double time;
+			Task::Handle handle;
+		};
+
+		struct JobWait
+		{
+			JobHandle job;
+			Task::Handle handle;
+		};
+
+		std::uint64_t m_Frame = 0;
+		double m_Time = 0;
+
+		mutable std::mutex m_StartMx;
+		std::vector<Task::Handle> m_StartedTasks;
+		// guarded by m_StartMx, because Tasks may be bound concurrently
+		std::unordered_map<Uid, std::size_t> m_BoundTaskCounts;
+		std::unordered_set<Uid> m_CancelledUids;
+
+		std::vector<Task::Handle> m_ReadyTasks;
+		std::vector<Task::Handle> m_ResumingTasks;
+		std::vector<FrameWait> m_FrameWaits;
+		std::vector<TimeWait> m_TimeWaits;
+		std::vector<JobWait> m_JobWaits;
+
+		void destroy(Task::Handle handle) noexcept
+		{
+			if (handle.promise().entityUid != 0)
+			{
+				std::scoped_lock lock{ m_StartMx };
+				destroyUnlocked(handle);
+			}
+			else
+			{
+				handle.destroy();
+			}
+		}
+
+		void destroyUnlocked(Task::Handle handle) noexcept
+		{
+			if (const auto uid = handle.promise().entityUid; uid != 0)
+			{
+				const auto itr = m_BoundTaskCounts.find(uid);
+				assert(itr != std::end(m_BoundTaskCounts));
+				if (--itr->second == 0)
+					m_BoundTaskCounts.erase(itr);
+			}
+			handle.destroy();
+		}
+	};
+
+	template <class TWait, auto TEnqueue>
+	struct TaskAwaiter
+	{
+		TWait wait;
+		bool ready = false;
+
+		[[nodiscard]] bool await_ready() const noexcept
+		{
+			return ready;
+		}
+
+		void await_suspend(Task::Handle handle)
+		{
+			(handle.promise().scheduler->*TEnqueue)(handle, std::move(wait));
+		}
+
+		void await_resume() const noexcept
+		{
+		}
+	};
+}
+
+namespace secs
+{
+	inline auto Task::promise_type::await_transform(WaitFrames wait) noexcept
+	{
+		return detail::TaskAwaiter<std::uint64_t, &detail::TaskScheduler::waitFrames>{ wait.count, wait.count == 0 };
+	}
+
+	inline auto Task::promise_type::await_transform(WaitTime wait) noexcept
+	{
+		return detail::TaskAwaiter<float, &detail::TaskScheduler::waitTime>{ wait.duration, wait.duration <= 0 };
+	}
+
+	inline auto Task::promise_type::await_transform(JobHandle job) noexcept
+	{
+		const bool finished = job.finished();
+		return detail::TaskAwaiter<JobHandle, &detail::TaskScheduler::waitJob>{ std::move(job), finished };
+	}
+}
+
+#endif
@@ -0,0 +1,274 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_TICK_DRIVER_HPP
+#define SECS_TICK_DRIVER_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
+#include "EmptyCallable.hpp"
+#include "World.hpp"
+
+namespace secs
+{
+	/** \struct TickDriverConfig
+	 * \brief Configuration of a TickDriver
+	 */
+	struct TickDriverConfig
+	{
+		/**
+		 * \brief Fixed duration of each simulation step.
+		 */
+		std::chrono::nanoseconds timestep = std::chrono::nanoseconds{ 1'000'000'000 } / 60;
+
+		/**
+		 * \brief Maximum amount of steps which will be executed to catch up with the real time. Exceeding time will be dropped.
+		 */
+		std::size_t maxCatchUpSteps = 5;
+
+		/**
+		 * \brief Remaining time until the next step, below which the TickDriver busy waits instead of sleeping.
+		 *
+		 * Sleeping is cheap but may wake up late, while busy waiting is precise but occupies the thread. Set to zero for pure sleeping.
+		 */
+		std::chrono::nanoseconds spinThreshold = std::chrono::microseconds{ 500 };
+	};
+
+	/** \struct TickStatistics
+	 * \brief Measurements gathered by a TickDriver
+	 */
+	struct TickStatistics
+	{
+		/**
+		 * \brief Amount of executed steps.
+		 */
+		std::uint64_t tickCount = 0;
+
+		/**
+		 * \brief Amount of steps which took longer than the timestep.
+		 */
+		std::uint64_t overrunCount = 0;
+
+		/**
+		 * \brief Amount of steps which have been dropped, because the maximum catch up steps were exceeded.
+		 */
+		std::uint64_t droppedTickCount = 0;
+
+		/**
+		 * \brief Duration of the most recent step.
+		 */
+		std::chrono::nanoseconds lastTickDuration{ 0 };
+
+		/**
+		 * \brief Duration of the longest step.
+		 */
+		std::chrono::nanoseconds maxTickDuration{ 0 };
+
+		/**
+		 * \brief Largest delay between the requested end of a sleep and the actual wake up of the TickDriver. It is measured before busy waiting,
+		 * thus it reflects the precision of the sleep.
+		 */
+		std::chrono::nanoseconds maxWakeUpLatency{ 0 };
+
+		/**
+		 * \brief Longest busy wait before a step.
+		 */
+		std::chrono::nanoseconds maxSpinDuration{ 0 };
+
+		/**
+		 * \brief Time spent busy waiting in total.
+		 */
+		std::chrono::nanoseconds totalSpinDuration{ 0 };
+	};
+
+	/** \class TickDriver
+	 * \brief Drives a World with a fixed timestep
+	 *
+	 * Elapsed real time is collected in an accumulator, which is consumed in fixed steps. Each step consists of the World's preUpdate, update and
+	 * postUpdate calls, where update always receives the timestep in seconds. If the simulation falls behind, at most maxCatchUpSteps will be
+	 * executed at once and the remaining time will be dropped, thus an overloaded simulation slows down instead of spiraling. The remaining
+	 * fraction of a step is exposed as interpolation alpha, which may be used for presenting states between the previous and the current step.
+	 *
+	 * The run function paces the loop by sleeping until shortly before the next step is due and busy waiting for the rest. On Linux sleeping is
+	 * done via clock_nanosleep with an absolute deadline, thus time spent in the loop itself does not accumulate as drift.
+	 */
+	class TickDriver
+	{
+	public:
+		/**
+		 * \brief Alias for the used clock.
+		 */
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * \brief Constructor
+		 * \param world The World which will be driven. Must outlive the TickDriver.
+		 * \param config The configuration.
+		 */
+		explicit TickDriver(World& world, TickDriverConfig config = {}) noexcept :
+			m_World{ world },
+			m_Config{ config }
+		{
+			assert(Clock::duration::zero() < m_Config.timestep);
+		}
+
+		/**
+		 * \brief Configuration
+		 * \return Returns a const reference to the configuration.
+		 */
+		[[nodiscard]] const TickDriverConfig& config() const noexcept
+		{
+			return m_Config;
+		}
+
+		/**
+		 * \brief Gathered measurements
+		 * \return Returns a const reference to the statistics.
+		 */
+		[[nodiscard]] const TickStatistics& statistics() const noexcept
+		{
+			return m_Statistics;
+		}
+
+		/**
+		 * \brief Interpolation alpha
+		 * \return Returns the not yet consumed fraction of a step, which is in range [0, 1).
+		 */
+		[[nodiscard]] float alpha() const noexcept
+		{
+			return std::chrono::duration<float>(m_Accumulator) / std::chrono::duration<float>(m_Config.timestep);
+		}
+
+		/**
+		 * \brief Advances the simulation
+		 *
+		 * Adds the elapsed time to the accumulator and executes as many fixed steps as possible, but at most maxCatchUpSteps.
+		 * \param elapsed Elapsed real time since the previous call.
+		 * \return Returns the amount of executed steps.
+		 */
+		std::size_t advance(Clock::duration elapsed)
+		{
+			m_Accumulator += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+
+			std::size_t steps = 0;
+			for (; m_Config.timestep <= m_Accumulator && steps < m_Config.maxCatchUpSteps; ++steps)
+			{
+				step();
+				m_Accumulator -= m_Config.timestep;
+			}
+
+			if (m_Config.timestep <= m_Accumulator)
+			{
+				m_Statistics.droppedTickCount += m_Accumulator / m_Config.timestep;
+				m_Accumulator %= m_Config.timestep;
+			}
+			return steps;
+		}
+
+		/**
+		 * \brief Runs the simulation loop
+		 *
+		 * Advances the simulation by the real time elapsed since the previous iteration and waits until the next step is due.
+		 * \tparam TPredicate Invokable predicate type.
+		 * \tparam TPresent Invokable type with a float parameter.
+		 * \param keepRunning Predicate which is checked once per iteration. The loop ends as soon as it returns false.
+		 * \param present Invoked once per iteration after advancing with the interpolation alpha.
+		 */
+		template <std::predicate TPredicate, std::invocable<float> TPresent = utils::EmptyCallable<>>
+		void run(TPredicate keepRunning, TPresent present = TPresent{})
+		{
+			auto previous = Clock::now();
+			while (keepRunning())
+			{
+				const auto now = Clock::now();
+				advance(now - previous);
+				previous = now;
+				present(alpha());
+
+				const auto deadline = now + (m_Config.timestep - m_Accumulator);
+				waitUntil(deadline);
+			}
+		}
+
+	private:
+		World& m_World;
+		TickDriverConfig m_Config;
+		TickStatistics m_Statistics;
+		std::chrono::nanoseconds m_Accumulator{ 0 };
+
+		void step()
+		{
+			const auto begin = Clock::now();
+			m_World.preUpdate();
+			m_World.update(std::chrono::duration<float>(m_Config.timestep).count());
+			m_World.postUpdate();
+			const std::chrono::nanoseconds duration = Clock::now() - begin;
+
+			++m_Statistics.tickCount;
+			m_Statistics.lastTickDuration = duration;
+			m_Statistics.maxTickDuration = std::max(m_Statistics.maxTickDuration, duration);
+			if (m_Config.timestep < duration)
+				++m_Statistics.overrunCount;
+		}
+
+		void waitUntil(Clock::time_point deadline) noexcept
+		{
+			if (const auto sleepDeadline = deadline - m_Config.spinThreshold; Clock::now() < sleepDeadline)
+			{
+				sleepUntil(sleepDeadline);
+				// busy waiting would hide a late wake up, thus it has to be measured right away
+				const std::chrono::nanoseconds latency = Clock::now() - sleepDeadline;
+				m_Statistics.maxWakeUpLatency = std::max(m_Statistics.maxWakeUpLatency, latency);
+			}
+
+			auto now = Clock::now();
+			if (deadline <= now)
+				return;
+
+			const auto spinBegin = now;
+			do
+			{
+				std::this_thread::yield();
+				now = Clock::now();
+			}
+			while (now < deadline);
+
+			const std::chrono::nanoseconds spinDuration = now - spinBegin;
+			m_Statistics.maxSpinDuration = std::max(m_Statistics.maxSpinDuration, spinDuration);
+			m_Statistics.totalSpinDuration += spinDuration;
+		}
+
+		static void sleepUntil(Clock::time_point deadline) noexcept
+		{
+#if defined(__linux__)
+			// steady_clock is based on CLOCK_MONOTONIC on Linux
+			const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+			timespec time{};
+			time.tv_sec = static_cast<time_t>(sinceEpoch / 1'000'000'000);
+			time.tv_nsec = static_cast<long>(sinceEpoch % 1'000'000'000);
+			while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) == EINTR)
+			{
+			}
+#else
+			std::this_thread::sleep_until(deadline);
+#endif
+		}
+	};
+}
+
+#endif
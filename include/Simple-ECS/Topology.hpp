@@ -0,0 +1,166 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_TOPOLOGY_HPP
+#define SECS_TOPOLOGY_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <filesystem>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace secs::detail
+{
+	struct NumaNode
+	{
+		int id = 0;
+		std::vector<int> cpus;
+	};
+
+	// parses lists like "0-3,8,10-11"
+	[[nodiscard]] inline std::vector<int> parseCpuList(std::string_view list)
+	{
+		std::vector<int> cpus;
+		while (!std::empty(list))
+		{
+			const auto separator = list.find(',');
+			auto range = list.substr(0, separator);
+			list = separator == std::string_view::npos ? std::string_view{} : list.substr(separator + 1);
+
+			while (!std::empty(range) && (range.back() == '\n' || range.back() == ' '))
+				range.remove_suffix(1);
+
+			int first = 0;
+			auto [ptr, ec] = std::from_chars(range.data(), range.data() + std::size(range), first);
+			if (ec != std::errc{})
+				continue;
+
+			int last = first;
+			if (ptr != range.data() + std::size(range) && *ptr == '-')
+				std::from_chars(ptr + 1, range.data() + std::size(range), last);
+
+			for (int cpu = first; cpu <= last; ++cpu)
+				cpus.emplace_back(cpu);
+		}
+		return cpus;
+	}
+
+	// Reads the NUMA nodes and their cpus. Systems without NUMA information are treated as one node containing all cpus.
+	[[nodiscard]] inline std::vector<NumaNode> queryNumaTopology()
+	{
+		std::vector<NumaNode> nodes;
+#if defined(__linux__)
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec))
+		{
+			const auto name = entry.path().filename().string();
+			int id = 0;
+			if (!name.starts_with("node") || std::from_chars(name.data() + 4, name.data() + std::size(name), id).ec != std::errc{})
+				continue;
+
+			std::ifstream file{ entry.path() / "cpulist" };
+			std::string cpuList;
+			if (std::getline(file, cpuList))
+			{
+				if (auto cpus = parseCpuList(cpuList); !std::empty(cpus))
+					nodes.push_back({ id, std::move(cpus) });
+			}
+		}
+		std::ranges::sort(nodes, {}, &NumaNode::id);
+#endif
+
+		if (std::empty(nodes))
+		{
+			NumaNode node;
+			node.cpus.resize(std::max(1u, std::thread::hardware_concurrency()));
+			for (std::size_t i = 0; i < std::size(node.cpus); ++i)
+				node.cpus[i] = static_cast<int>(i);
+			nodes.emplace_back(std::move(node));
+		}
+		return nodes;
+	}
+
+	// upper bound for cpu indices, which protects against allocating huge sets for invalid indices
+	inline constexpr int maxCpuCount = 1 << 16;
+
+	inline bool pinCurrentThread(int cpu) noexcept
+	{
+#if defined(__linux__)
+		if (cpu < 0 || maxCpuCount <= cpu)
+			return false;
+
+		// dynamically sized, because cpu_set_t is limited to CPU_SETSIZE cpus
+		auto* set = CPU_ALLOC(cpu + 1);
+		if (!set)
+			return false;
+
+		const auto size = CPU_ALLOC_SIZE(cpu + 1);
+		CPU_ZERO_S(size, set);
+		CPU_SET_S(cpu, size, set);
+		const auto result = pthread_setaffinity_np(pthread_self(), size, set) == 0;
+		CPU_FREE(set);
+		return result;
+#else
+		return false;
+#endif
+	}
+
+	// returns -1 if unknown
+	[[nodiscard]] inline int currentCpu() noexcept
+	{
+#if defined(__linux__)
+		return sched_getcpu();
+#else
+		return -1;
+#endif
+	}
+
+	[[nodiscard]] inline std::size_t pageSize() noexcept
+	{
+#if defined(__linux__)
+		static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		return size;
+#else
+		return 4096;
+#endif
+	}
+
+	// Queries the NUMA node of the pages containing the passed addresses; -1 for unknown or not yet populated pages.
+	[[nodiscard]] inline std::vector<int> queryMemoryNodes(std::span<const void* const> addresses)
+	{
+		std::vector<int> nodes(std::size(addresses), -1);
+#if defined(__linux__) && defined(SYS_move_pages)
+		if (!std::empty(addresses))
+		{
+			// move_pages only queries the nodes, if no target nodes are passed
+			std::vector<void*> pages(std::size(addresses));
+			std::ranges::transform(addresses, std::begin(pages), [](const void* address) { return const_cast<void*>(address); });
+			if (syscall(SYS_move_pages, 0, std::size(pages), pages.data(), nullptr, nodes.data(), 0) != 0)
+				std::ranges::fill(nodes, -1);
+			std::ranges::replace_if(nodes, [](int node) { return node < 0; }, -1);
+		}
+#endif
+		return nodes;
+	}
+}
+
+#endif
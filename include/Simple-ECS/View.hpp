@@ -0,0 +1,157 @@
+//          Copyright Dominic Koepke 2020 - 2020.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SECS_VIEW_HPP
+#define SECS_VIEW_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Concepts.hpp"
+#include "Defines.hpp"
+#include "Entity.hpp"
+#include "System.hpp"
+
+namespace secs::detail
+{
+	template <class... T>
+	inline constexpr bool areUnique = true;
+
+	template <class T, class... TOthers>
+	inline constexpr bool areUnique<T, TOthers...> = (!std::same_as<T, TOthers> && ...) && areUnique<TOthers...>;
+}
+
+namespace secs
+{
+	template <class TIncludeList, class TExcludeList = TypeList<>>
+	class View;
+
+	/** \class View
+	 * \brief Joins the storages of multiple Systems
+	 *
+	 * Views are created via World::view and visit each active Component of the included types, which belong to the same Entity. Iteration is driven
+	 * by the smallest of the included storages; the other Components are probed via the Entity. Each probe searches the Components of the Entity
+	 * linearly, thus its costs grow with the amount of Components per Entity. Entities owning any of the excluded Component types are skipped.
+	 * Views are cheap to copy and do not cache anything, thus they may be created each frame.
+	 *
+	 * Included types may be const qualified. Those Components are passed as const references and will not be reported as changed. Each Component
+	 * type may be included only once, regardless of its qualification.
+	 * \tparam TInclude Included Component types.
+	 * \tparam TExclude Excluded Component types.
+	 */
+	template <class... TInclude, class... TExclude>
+	class View<TypeList<TInclude...>, TypeList<TExclude...>>
+	{
+		template <class, class>
+		friend class View;
+
+		static_assert(0 < sizeof...(TInclude), "View needs at least one included Component type.");
+		static_assert(detail::areUnique<std::remove_const_t<TInclude>...>, "View must not include a Component type more than once.");
+
+	public:
+		/**
+		 * \brief Constructor
+		 * \param systems The Systems of the included Component types.
+		 */
+		explicit View(SystemBase<std::remove_const_t<TInclude>>&... systems) noexcept :
+			m_Systems{ &systems... }
+		{
+		}
+
+		/**
+		 * \brief Excludes further Component types
+		 * \tparam TOther Component types to be excluded.
+		 * \return Returns a new View, which additionally skips Entities owning any of the passed Component types.
+		 */
+		template <Component... TOther>
+		[[nodiscard]] View<TypeList<TInclude...>, TypeList<TExclude..., TOther...>> without() const noexcept
+		{
+			return View<TypeList<TInclude...>, TypeList<TExclude..., TOther...>>{ m_Systems };
+		}
+
+		/**
+		 * \brief Upper bound of visited Entities
+		 * \return Returns the size of the smallest included storage.
+		 */
+		[[nodiscard]] std::size_t sizeHint() const noexcept
+		{
+			return std::apply([](const auto*... systems) { return std::min({ systems->size()... }); }, m_Systems);
+		}
+
+		/**
+		 * \brief Executes action on each matching Entity
+		 * \remark Creating or destroying Components of the included types during iteration is not allowed.
+		 * \tparam TAction Invokable object with specific signature.
+		 * \param action Invokable object.
+		 */
+		template <std::invocable<Entity&, TInclude&...> TAction>
+		void forEach(TAction action) const
+		{
+			forEachInStorage(smallestStorageIndex(), action, std::index_sequence_for<TInclude...>{});
+		}
+
+	private:
+		std::tuple<SystemBase<std::remove_const_t<TInclude>>*...> m_Systems;
+
+		explicit View(std::tuple<SystemBase<std::remove_const_t<TInclude>>*...> systems) noexcept :
+			m_Systems{ systems }
+		{
+		}
+
+		[[nodiscard]] std::size_t smallestStorageIndex() const noexcept
+		{
+			const auto sizes = std::apply([](const auto*... systems) { return std::array{ systems->size()... }; }, m_Systems);
+			return std::distance(std::begin(sizes), std::ranges::min_element(sizes));
+		}
+
+		template <class TAction, std::size_t... VIndex>
+		void forEachInStorage(std::size_t storageIndex, TAction& action, std::index_sequence<VIndex...>) const
+		{
+			// exactly one storage drives the iteration
+			((VIndex == storageIndex ? forEachEntity(*std::get<VIndex>(m_Systems), action) : void()), ...);
+		}
+
+		template <class TSystem, class TAction>
+		void forEachEntity(TSystem& drivingSystem, TAction& action) const
+		{
+			for (auto& entity : drivingSystem.entities())
+			{
+				if ((entity.template hasComponent<TExclude>() || ...))
+					continue;
+
+				auto components = std::tuple{ probe<TInclude>(entity)... };
+				if (std::apply([](const auto*... component) { return ((component != nullptr) && ...); }, components))
+					std::apply([&](auto*... component) { action(entity, *component...); }, components);
+			}
+		}
+
+		template <class T>
+		[[nodiscard]] T* probe(Entity& entity) const noexcept
+		{
+			using ComponentType = std::remove_const_t<T>;
+			auto* system = std::get<SystemBase<ComponentType>*>(m_Systems);
+			// linear in the Component count of the Entity
+			const auto itr = std::ranges::find(entity.m_ComponentInfos, typeid(ComponentType), &detail::ComponentStorageInfo::componentTypeIndex);
+			if (itr == std::end(entity.m_ComponentInfos) || itr->system != system)
+				return nullptr;
+
+			// const Components are not reported as changed
+			if constexpr (std::is_const_v<T>)
+				return std::as_const(*system).findComponent(itr->componentUid);
+			else
+				return system->findComponent(itr->componentUid);
+		}
+	};
+}
+
+#endif
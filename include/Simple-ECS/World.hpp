@@ -8,19 +8,153 @@
 
 #pragma once
 
+#include <algorithm>
+#include <exception>
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <queue>
 #include <ranges>
 #include <string>
 #include <typeinfo>
+#include <typeindex>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "ComponentIndex.hpp"
 #include "Concepts.hpp"
 #include "Entity.hpp"
+#include "EntityTable.hpp"
+#include "Group.hpp"
+#include "JobSystem.hpp"
+#include "Observer.hpp"
+#include "Query.hpp"
 #include "System.hpp"
+#include "Task.hpp"
+#include "Topology.hpp"
+#include "View.hpp"
+
+namespace secs
+{
+	/** \struct DefaultPhase
+	 * \brief Phase of each System which does not declare a Phase on its own.
+	 *
+	 * If not explicitly listed via World::setPhaseOrder, this phase precedes every other phase.
+	 */
+	struct DefaultPhase
+	{
+	};
+}
+
+namespace secs::detail
+{
+	template <class... TComponent>
+	struct ComponentSignature
+	{
+	};
+
+	struct EntityPool
+	{
+		std::vector<std::unique_ptr<Entity>> entities;
+	};
+
+	template <class TSystem>
+	concept DeclaresSystemAccess = requires { typename TSystem::ReadAccess; } || requires { typename TSystem::WriteAccess; };
+
+	template <class... T>
+	[[nodiscard]] std::vector<std::type_index> makeTypeIndices(TypeList<T...>)
+	{
+		return { typeid(std::remove_cvref_t<T>)... };
+	}
+
+	struct SystemAccess
+	{
+		std::vector<std::type_index> reads;
+		std::vector<std::type_index> writes;
+		// Systems without any access declaration conflict with every other System
+		bool exclusive = true;
+
+		template <class TSystem>
+		[[nodiscard]] static SystemAccess make()
+		{
+			SystemAccess access;
+			if constexpr (DeclaresSystemAccess<TSystem>)
+			{
+				access.exclusive = false;
+				if constexpr (requires { typename TSystem::ReadAccess; })
+					access.reads = makeTypeIndices(typename TSystem::ReadAccess{});
+				if constexpr (requires { typename TSystem::WriteAccess; })
+					access.writes = makeTypeIndices(typename TSystem::WriteAccess{});
+			}
+			return access;
+		}
+
+		[[nodiscard]] bool conflictsWith(const SystemAccess& other) const noexcept
+		{
+			auto intersects = [](const auto& lhs, const auto& rhs)
+			{
+				return std::ranges::any_of(lhs, [&rhs](const auto& type) { return std::ranges::find(rhs, type) != std::end(rhs); });
+			};
+
+			return exclusive || other.exclusive ||
+				intersects(writes, other.writes) || intersects(writes, other.reads) || intersects(reads, other.writes);
+		}
+	};
+
+	// The System, whose preUpdate, update or postUpdate is currently executed on this thread; used for validating Entity creation.
+	struct SystemContext
+	{
+		const void* world = nullptr;
+		const SystemAccess* access = nullptr;
+	};
+
+	[[nodiscard]] inline SystemContext& currentSystemContext() noexcept
+	{
+		thread_local SystemContext context;
+		return context;
+	}
+
+	struct SystemOrdering
+	{
+		std::type_index phase = typeid(DefaultPhase);
+		std::vector<std::type_index> runBefore;
+		std::vector<std::type_index> runAfter;
+		std::uint64_t tickDivisor = 1;
+		std::uint64_t tickOffset = 0;
+
+		template <class TSystem>
+		[[nodiscard]] static SystemOrdering make()
+		{
+			SystemOrdering ordering;
+			if constexpr (requires { typename TSystem::Phase; })
+				ordering.phase = typeid(typename TSystem::Phase);
+			if constexpr (requires { typename TSystem::RunBefore; })
+				ordering.runBefore = makeTypeIndices(typename TSystem::RunBefore{});
+			if constexpr (requires { typename TSystem::RunAfter; })
+				ordering.runAfter = makeTypeIndices(typename TSystem::RunAfter{});
+			if constexpr (requires { TSystem::tickDivisor; })
+			{
+				static_assert(0 < TSystem::tickDivisor, "tickDivisor must be greater than zero.");
+				ordering.tickDivisor = TSystem::tickDivisor;
+			}
+			if constexpr (requires { TSystem::tickOffset; })
+				ordering.tickOffset = TSystem::tickOffset % ordering.tickDivisor;
+			return ordering;
+		}
+
+		[[nodiscard]] bool ticksAt(std::uint64_t frameIndex) const noexcept
+		{
+			return frameIndex % tickDivisor == tickOffset;
+		}
+	};
+}
 
 namespace secs
 {
@@ -32,21 +166,80 @@ namespace secs
 	 * is generally no thread-safe action. Systems are stored internally and each System type will be unique, thus
 	 * if you register a system type twice or more, you will override the previous stored object.
 	 *
-	 * <STRONG>Systems will be updated in order of their registration.</STRONG>
+	 * <STRONG>Systems will be updated in order of their registration, unless they declare otherwise.</STRONG>
+	 *
+	 * Each System belongs to a phase, which is declared via the member alias Phase (any tag type). Systems without such a declaration belong to
+	 * DefaultPhase. Phases are executed in the order passed to setPhaseOrder, with a barrier between each of them. Within a phase, a System may
+	 * declare the Systems it has to precede or follow via the member aliases RunBefore and RunAfter (both being a TypeList of System types);
+	 * constraints on Systems which are not registered are ignored. Beyond that, Systems keep their registration order.
+	 *
+	 * Systems may run less frequently by declaring a static member tickDivisor (and optionally tickOffset). Such a System will only be
+	 * updated during frames whose index modulo tickDivisor equals tickOffset; its update receives the deltas of all frames since its previous
+	 * update. The frame index is incremented at the end of each postUpdate call.
+	 *
+	 * If the World owns worker threads, Systems may be updated in parallel. Each System may declare the Components and other resources it
+	 * accesses via the member aliases ReadAccess and WriteAccess (both being a TypeList). Systems whose accesses conflict (at least one of
+	 * them writes a type the other one reads or writes) will still be updated in their determined order, while all other Systems of the same
+	 * phase run concurrently. Systems without any declaration conflict with every other System.
 	 *
-	 * Creating Entities is designed to be thread-safe and can therefore happen anywhere in the program. They may also be
-	 * registered for destruction anytime. Please keep in mind, that Entities will not directly be destroyed and will
-	 * be valid for at least one update cycle, so that each System can safely perform their cleanup processes.
+	 * Creating Entities is thread-safe in respect to other Entity creations. Creating a Component may grow the storage of its System, thus while
+	 * Systems are executed (during preUpdate, update and postUpdate of the World), Entities may only be created by Systems, which declare write
+	 * access to each created Component type or which do not declare any access at all; this is asserted in debug builds. Entities may be registered
+	 * for destruction anytime. Please keep in mind, that Entities will not directly be destroyed and will be valid for at least one update cycle, so
+	 * that each System can safely perform their cleanup processes.
 	 */
 	class World
 	{
 	public:
+		/**
+		 * \brief Default Constructor
+		 *
+		 * Constructs a World without any worker threads, thus each System will be updated on the calling thread.
+		 */
+		World() = default;
+
+		/**
+		 * \brief Constructor
+		 * \param workerCount Amount of worker threads owned by the JobSystem of this World. They are used for updating Systems in parallel
+		 * and are also available to Systems for their own work.
+		 */
+		explicit World(std::size_t workerCount) :
+			m_JobSystem{ workerCount }
+		{
+		}
+
+		/**
+		 * \brief Constructor
+		 * \param jobSystemConfig Configuration of the JobSystem owned by this World.
+		 */
+		explicit World(const JobSystemConfig& jobSystemConfig) :
+			m_JobSystem{ jobSystemConfig }
+		{
+		}
+
+		World(const World&) = delete;
+		World& operator =(const World&) = delete;
+		World(World&&) = delete;
+		World& operator =(World&&) = delete;
+
+		/**
+		 * \brief Destructor
+		 *
+		 * Waits for a pending pipelined teardown before anything gets destructed.
+		 */
+		~World() noexcept
+		{
+			finishTeardown();
+		}
+
 		/**
 		 * \brief Registers System
 		 *
 		 * This function will create and register a new System object in place at this World. If there already exists a System of type TSystem,
 		 * it will be overridden.
 		 * \tparam TSystem Concrete System type. Needs to be explicitly specified.
+		 * \throws SystemError if the phase of TSystem has not been passed to setPhaseOrder, or if the ordering constraints of the registered
+		 * Systems contradict each other or the phase order. The World stays unchanged in that case.
 		 * \tparam TArgs Constructor parameter types.
 		 * \param args TSystem constructor parameters.
 		 * \return Reference to the registered System object.
@@ -54,15 +247,47 @@ namespace secs
 		template <System TSystem, class... TArgs>
 		constexpr TSystem& registerSystem(TArgs&&... args)
 		{
+			// the pipelined teardown may still access the previous System object
+			finishTeardown();
+
 			auto system = std::make_unique<TSystem>(std::forward<TArgs>(args)...);
+			system->m_ObservesEntityStates = SystemBase<typename TSystem::ComponentType>::template observesEntityStates<TSystem>();
+			system->m_JobSystem = &m_JobSystem;
+			system->m_TaskScheduler = &m_TaskScheduler;
+			system->m_FrameIndex = &m_FrameIndex;
 			auto& ref = *system;
+			SystemStorage storage{
+				typeid(TSystem),
+				typeid(typename TSystem::ComponentType),
+				std::move(system),
+				detail::SystemAccess::make<TSystem>(),
+				detail::SystemOrdering::make<TSystem>()
+			};
 			if (auto itr = findSystemStorage<TSystem>(*this); itr != std::end(m_Systems))
 			{
-				*itr = { typeid(TSystem), typeid(typename TSystem::ComponentType), std::move(system) };
+				std::swap(*itr, storage);
+				try
+				{
+					buildSystemSchedule();
+				}
+				catch (...)
+				{
+					std::swap(*itr, storage);
+					throw;
+				}
 			}
 			else
 			{
-				m_Systems.emplace_back(typeid(TSystem), typeid(typename TSystem::ComponentType), std::move(system));
+				m_Systems.emplace_back(std::move(storage));
+				try
+				{
+					buildSystemSchedule();
+				}
+				catch (...)
+				{
+					m_Systems.pop_back();
+					throw;
+				}
 			}
 			return ref;
 		}
@@ -191,28 +416,355 @@ namespace secs
 			return const_cast<SystemBase<TComponent>&>(std::as_const(*this).systemByComponentType<TComponent>());
 		}
 
+		/**
+		 * \brief Creates a View joining multiple Component types
+		 *
+		 * See \ref View for details. Use View::without to exclude further Component types.
+		 * \throws SystemError if a related SystemBase object could not be found for any of the Component types.
+		 * \tparam TComponent Included Component types, which may be const qualified.
+		 * \return Returns a View over each Entity owning all of the passed Component types.
+		 */
+		template <class... TComponent>
+			requires (Component<std::remove_const_t<TComponent>> && ...)
+		[[nodiscard]] View<TypeList<TComponent...>> view()
+		{
+			return View<TypeList<TComponent...>>{ systemByComponentType<std::remove_const_t<TComponent>>()... };
+		}
+
+		/**
+		 * \brief Registers a Query
+		 *
+		 * Creates the Query on the first call and fills it with the matching Entities, which already exist. Subsequent calls return the same Query.
+		 * See \ref Query for details.
+		 * \remark This function is not thread-safe and should be called during setup, similar to registerSystem.
+		 * \throws SystemError if a related SystemBase object could not be found for any of the included Component types.
+		 * \tparam TIncludeList TypeList of included Component types, which may be const qualified.
+		 * \tparam TExcludeList TypeList of excluded Component types.
+		 * \return Reference to the Query, which stays valid until the World is destructed.
+		 */
+		template <class TIncludeList, class TExcludeList = TypeList<>>
+		Query<TIncludeList, TExcludeList>& query()
+		{
+			return registerQuery<Query<TIncludeList, TExcludeList>>(TIncludeList{});
+		}
+
+		/**
+		 * \brief Registers an owning Group
+		 *
+		 * Creates the Group on the first call and sorts the Components of the already existing matching Entities into it. Subsequent calls return the
+		 * same Group. See \ref Group for details.
+		 * \remark This function is not thread-safe and should be called during setup, similar to registerSystem.
+		 * \throws SystemError if a related SystemBase object could not be found for any of the Component types, or if any of them is already owned
+		 * by another Group.
+		 * \tparam TComponent Owned Component types, which may be const qualified.
+		 * \return Reference to the Group, which stays valid until the World is destructed.
+		 */
+		template <class... TComponent>
+			requires (Component<std::remove_const_t<TComponent>> && ...)
+		Group<TypeList<TComponent...>>& group()
+		{
+			return registerQuery<Group<TypeList<TComponent...>>>(TypeList<TComponent...>{});
+		}
+
+		/**
+		 * \brief Registers a secondary index on a Component field
+		 *
+		 * Creates the index on the first call and fills it with the matching Entities, which already exist. Subsequent calls return the same index.
+		 * See \ref ComponentIndex for details.
+		 * \remark This function is not thread-safe and should be called during setup, similar to registerSystem.
+		 * \throws SystemError if a related SystemBase object could not be found for the Component type.
+		 * \tparam VMember Pointer to the indexed data member of a Component type, e.g. &Team::id.
+		 * \tparam VKind The lookup structure.
+		 * \return Reference to the index, which stays valid until the World is destructed.
+		 */
+		template <auto VMember, IndexKind VKind = IndexKind::hash>
+		ComponentIndex<VMember, VKind>& index()
+		{
+			using Index = ComponentIndex<VMember, VKind>;
+			return registerQuery<Index>(TypeList<typename Index::ComponentType>{});
+		}
+
+		/**
+		 * \brief Reserves Component slots on a NUMA node
+		 *
+		 * Appends empty slots to the storage of the System related to TComponent, which will be used by subsequently created Components. The
+		 * slots are initialized by a worker of the passed node, thus the operating system's first touch policy places their memory on that node.
+		 * If the node has no workers, the slots are initialized by the calling thread.
+		 * \remark Only the placement of the memory is affected. Updates of the System are still scheduled on any worker, thus the Components may be
+		 * processed by workers of other nodes.
+		 * \remark This function is not thread-safe and should be called during setup, similar to registerSystem.
+		 * \throws SystemError if a related SystemBase object could not be found.
+		 * \tparam TComponent Component type.
+		 * \param count Amount of slots.
+		 * \param node Id of the NUMA node. std::nullopt initializes the slots on the calling thread.
+		 */
+		template <Component TComponent>
+		void reserveComponents(std::size_t count, std::optional<int> node = std::nullopt)
+		{
+			auto& system = systemByComponentType<TComponent>();
+			if (auto workerIndex = node ? m_JobSystem.findWorkerOnNode(*node) : std::nullopt)
+			{
+				// jobs must not throw
+				std::exception_ptr exception;
+				m_JobSystem.waitFor(
+									m_JobSystem.runOnWorker(
+															*workerIndex,
+															[&]
+															{
+																try
+																{
+																	system.reserveComponentSlots(count);
+																}
+																catch (...)
+																{
+																	exception = std::current_exception();
+																}
+															}
+														)
+								);
+				if (exception)
+					std::rethrow_exception(exception);
+			}
+			else
+			{
+				system.reserveComponentSlots(count);
+			}
+		}
+
+		/**
+		 * \brief Reports the placement of a Component storage
+		 *
+		 * Queries the NUMA nodes of the memory pages occupied by the storage of the System related to TComponent. Node id -1 counts pages whose
+		 * node could not be determined, e.g. on platforms without NUMA support.
+		 * \throws SystemError if a related SystemBase object could not be found.
+		 * \tparam TComponent Component type.
+		 * \return Returns the amount of pages per node id.
+		 */
+		template <Component TComponent>
+		[[nodiscard]] std::map<int, std::size_t> componentPlacement() const
+		{
+			const auto& system = systemByComponentType<TComponent>();
+			const auto pageMask = ~(static_cast<std::uintptr_t>(detail::pageSize()) - 1u);
+			std::vector<const void*> pages;
+			for (const auto& slot : system.m_Components)
+			{
+				const auto page = reinterpret_cast<std::uintptr_t>(&slot) & pageMask;
+				if (std::empty(pages) || reinterpret_cast<std::uintptr_t>(pages.back()) != page)
+					pages.emplace_back(reinterpret_cast<const void*>(page));
+			}
+
+			std::map<int, std::size_t> placement;
+			for (auto node : detail::queryMemoryNodes(pages))
+				++placement[node];
+			return placement;
+		}
+
+		/**
+		 * \brief Sets the order of phases
+		 *
+		 * Each System whose Phase is not part of the passed phases can not be registered. DefaultPhase may be listed explicitly; otherwise it
+		 * precedes all passed phases.
+		 * \throws SystemError if any of the already registered Systems belongs to a phase, which is not part of the passed phases. The
+		 * previous phase order stays active in that case.
+		 * \tparam TPhase Phase tag types in order of their execution.
+		 */
+		template <class... TPhase>
+		void setPhaseOrder()
+		{
+			auto previousOrder = std::exchange(m_PhaseOrder, { typeid(TPhase)... });
+			try
+			{
+				buildSystemSchedule();
+			}
+			catch (...)
+			{
+				m_PhaseOrder = std::move(previousOrder);
+				throw;
+			}
+		}
+
+		/**
+		 * \brief Creates an Observer
+		 *
+		 * The returned Observer accumulates the Entities matching TEvent and TFilter from now on, until it is removed via removeObserver. Changed
+		 * events are only reported for running Entities, thus newly created Entities should be observed via Added.
+		 * \remark This function is not thread-safe and should not be called concurrently to postUpdate.
+		 * \tparam TEvent One of the event tags Added, Removed or Changed.
+		 * \tparam TFilter A With tag listing further Component types, which the Entities must own.
+		 * \return Reference to the Observer, which stays valid until it is removed or the World is destructed.
+		 */
+		template <detail::ObserverEventTag TEvent, detail::ObserverFilterTag TFilter = With<>>
+		Observer& observe()
+		{
+			using Traits = detail::ObserverEventTraits<TEvent>;
+			using ComponentType = std::remove_cvref_t<typename Traits::ComponentType>;
+			auto& observer = *m_Observers.emplace_back(
+														new Observer{
+															Traits::event,
+															typeid(ComponentType),
+															detail::ObserverFilterTraits<TFilter>::types()
+														}
+													);
+			if constexpr (Traits::event == ObserverEvent::changed)
+			{
+				observer.m_CollectChanges = &collectChangedComponents<ComponentType>;
+				// Skip everything which happened before. Components changed afterwards must receive a greater version, thus the counter has to
+				// be advanced.
+				if (auto* system = findSystemByComponentType<ComponentType>())
+					observer.m_ChangeVersion = system->m_ChangeVersion.increment();
+			}
+			return observer;
+		}
+
+		/**
+		 * \brief Removes an Observer
+		 *
+		 * The Observer will be destructed, thus any reference to it becomes invalid.
+		 * \remark This function is not thread-safe and should not be called concurrently to postUpdate.
+		 * \param observer The Observer previously created via observe.
+		 */
+		void removeObserver(const Observer& observer)
+		{
+			std::erase_if(m_Observers, [&observer](const auto& ptr) { return ptr.get() == &observer; });
+		}
+
+		/**
+		 * \brief Enables or disables the pipelined teardown
+		 *
+		 * By default, the Components of Entities which leave their teardown state are destructed during postUpdate on the calling thread. With
+		 * enabled pipelining, postUpdate only moves the Components out of their Systems and frees their slots; destructing the moved Components
+		 * is done by a job, which overlaps with the next frame's preUpdate and update. The job is awaited at the beginning of the next
+		 * Entity destruction stage, during registerSystem and during the World's destruction.
+		 *
+		 * The guarantees for Entities in teardown state stay the same: they and their Components stay valid for exactly one update cycle and
+		 * are removed from their Systems during the following postUpdate. The only difference is the thread on which the Component destructors
+		 * run, thus <STRONG>Component destructors must not access Systems or other shared state without synchronization</STRONG>.
+		 * Pipelining needs at least one worker thread to actually overlap.
+		 * \param enable True to enable pipelining.
+		 */
+		void setPipelinedTeardown(bool enable) noexcept
+		{
+			if (!enable)
+				finishTeardown();
+			m_PipelinedTeardown = enable;
+		}
+
+		/**
+		 * \brief Checks if pipelined teardown is enabled
+		 * \return True if pipelining is enabled.
+		 */
+		[[nodiscard]] bool pipelinedTeardown() const noexcept
+		{
+			return m_PipelinedTeardown;
+		}
+
+		/**
+		 * \brief Index of the current frame
+		 * \return Returns the amount of finished postUpdate calls.
+		 */
+		[[nodiscard]] std::uint64_t frameIndex() const noexcept
+		{
+			return m_FrameIndex;
+		}
+
+		/**
+		 * \brief JobSystem of this World
+		 * \return Reference to the JobSystem owned by this World.
+		 */
+		[[nodiscard]] JobSystem& jobSystem() noexcept
+		{
+			return m_JobSystem;
+		}
+
+		/**
+		 * \brief JobSystem of this World
+		 * \return Const reference to the JobSystem owned by this World.
+		 */
+		[[nodiscard]] const JobSystem& jobSystem() const noexcept
+		{
+			return m_JobSystem;
+		}
+
+		/**
+		 * \brief Starts a Task
+		 *
+		 * The Task will be resumed during the next update call, after each System has been updated. See \ref Task for details.
+		 * \remark This function is thread-safe.
+		 * \param task The Task to be started.
+		 */
+		void startTask(Task task)
+		{
+			m_TaskScheduler.start(std::move(task));
+		}
+
+		/**
+		 * \brief Starts a Task which is bound to an Entity
+		 *
+		 * Similar to the unbound overload, but the Task will be destroyed instead of resumed as soon as the Entity is torn down.
+		 * \remark This function is thread-safe.
+		 * \param entity The Entity the Task is bound to.
+		 * \param task The Task to be started.
+		 */
+		void startTask(const Entity& entity, Task task)
+		{
+			m_TaskScheduler.start(std::move(task), entity.uid());
+		}
+
+		/**
+		 * \brief Task count
+		 * \remark This function must not be called concurrently to update.
+		 * \return Returns amount of started and not yet finished Tasks.
+		 */
+		[[nodiscard]] std::size_t taskCount() const noexcept
+		{
+			return m_TaskScheduler.taskCount();
+		}
+
 		/**
 		 * \brief Creates new Entity with specified Components
 		 *
 		 * A new Entity with one Component object for each of the passed Component types will be created. It is safe to use and store
 		 * the reference to the newly constructed Entity.
+		 * \remark While Systems are executed, this function may only be called from the preUpdate, update or postUpdate of a System, which declares
+		 * write access to each of the passed Component types or which does not declare any access. Otherwise it may be called from any thread.
 		 * \tparam TComponent Indefinite amount of Component types
 		 * \return Returns a reference to the newly constructed Entity.
 		 */
 		template <Component... TComponent>
 		Entity& createEntity()
 		{
+			assert(mayCreateComponents<TComponent...>() && "Creating these Components may grow storages, which are concurrently read.");
 			std::scoped_lock entityLock{ m_NewEntityMx };
 
-			auto entityUID = m_NextUID++;
-			m_NewEntities.emplace_back(
-										std::make_unique<Entity>(
-																entityUID,
-																std::vector<detail::ComponentStorageInfo>{ makeComponentStorageInfo(systemByComponentType<TComponent>())... }
-																)
-									);
+			const auto entityUID = m_NextUID;
+			auto* pool = findEntityPool<TComponent...>();
+			auto& entity = *m_NewEntities.emplace_back(
+														pool && !std::empty(pool->entities)
+															? recycleEntity(*pool, entityUID)
+															: makeEntity<TComponent...>(entityUID, pool)
+													);
+			++m_NextUID;
+			m_EntityTable.insert(entityUID, entity);
 			++m_EntityCount;
-			return *m_NewEntities.back();
+			return entity;
+		}
+
+		/**
+		 * \brief Enables recycling for Entities with the specified Components
+		 *
+		 * Destroyed Entities which have been created via createEntity with exactly the passed Component types (in that order) will not be
+		 * deleted anymore, but returned to a pool instead. Their Component slots stay reserved in the corresponding Systems, but are
+		 * treated as absent. Subsequent createEntity calls with the same Component types reuse the pooled Entities, where each Component
+		 * will be reinitialized via assignment of a value initialized object. Recycled Entities receive a new uid as usual. As findEntity results
+		 * stay valid for a while, destroyed Entities return to their pool during the second postUpdate after their removal.
+		 * \remark This function is not thread-safe and should be called during setup, similar to registerSystem. Only Entities created after this call
+		 * will be recycled.
+		 * \tparam TComponent Component types of the Entity signature.
+		 */
+		template <Component... TComponent>
+		void enableEntityRecycling()
+		{
+			m_EntityPools.try_emplace(typeid(detail::ComponentSignature<std::remove_cvref_t<TComponent>...>));
 		}
 
 		/**
@@ -232,43 +784,25 @@ namespace secs
 		/**
 		 * \brief Searches for the corresponding Entity
 		 *
-		 * This function searches for the Entity with the passed uid. Due to the huge amount of different containers which
-		 * have to be searched, this is a quite expensive operation and should therefore be avoided if not necessary. Cache
-		 * pointers or references instead.
+		 * This function searches for the Entity with the passed uid, regardless of its current state. The lookup is lock-free and
+		 * thus may be performed from multiple threads, even concurrently to Entity creation and the World's postUpdate. Entities are not
+		 * destructed or recycled immediately after their removal, thus a found Entity stays valid until the second postUpdate after the
+		 * one which removed it. Its Components may already be destructed by then.
 		 * \param uid Entity Uid
 		 * \return Const pointer to the corresponding Entity or nullptr if not found.
 		 */
 		[[nodiscard]] const Entity* findEntity(Uid uid) const noexcept
 		{
-			std::scoped_lock entityLock{ m_EntityMx, m_NewEntityMx };
-			if (const auto itr = findEntityItr(m_Entities, uid); itr != std::end(m_Entities))
-			{
-				return &**itr;
-			}
-
-			if (const auto itr = findEntityItr(m_InitializingEntities, uid); itr != std::end(m_InitializingEntities))
-			{
-				return &**itr;
-			}
-
-			if (const auto itr = findEntityItr(m_NewEntities, uid); itr != std::end(m_NewEntities))
-			{
-				return &**itr;
-			}
-
-			if (const auto itr = findEntityItr(m_TeardownEntities, uid); itr != std::end(m_TeardownEntities))
-			{
-				return &**itr;
-			}
-			return nullptr;
+			return m_EntityTable.find(uid);
 		}
 
 		/**
 		 * \brief Searches for the corresponding Entity
 		 *
-		 * This function searches for the Entity with the passed uid. Due to the huge amount of different containers which
-		 * have to be searched, this is a quite expensive operation and should therefore be avoided if not necessary. Cache
-		 * pointers or references instead.
+		 * This function searches for the Entity with the passed uid, regardless of its current state. The lookup is lock-free and
+		 * thus may be performed from multiple threads, even concurrently to Entity creation and the World's postUpdate. Entities are not
+		 * destructed or recycled immediately after their removal, thus a found Entity stays valid until the second postUpdate after the
+		 * one which removed it. Its Components may already be destructed by then.
 		 * \param uid Entity Uid
 		 * \return Pointer to the corresponding Entity or nullptr if not found.
 		 */
@@ -280,9 +814,10 @@ namespace secs
 		/**
 		 * \brief Searches for the corresponding Entity
 		 *
-		 * This function searches for the Entity with the passed uid. Due to the huge amount of different containers which
-		 * have to be searched, this is a quite expensive operation and should therefore be avoided if not necessary. Cache
-		 * pointers or references instead.
+		 * This function searches for the Entity with the passed uid, regardless of its current state. The lookup is lock-free and
+		 * thus may be performed from multiple threads, even concurrently to Entity creation and the World's postUpdate. Entities are not
+		 * destructed or recycled immediately after their removal, thus a found Entity stays valid until the second postUpdate after the
+		 * one which removed it. Its Components may already be destructed by then.
 		 * \throws EntityError if corresponding Entity could not be found.
 		 * \param uid Entity Uid
 		 * \return Const reference to the corresponding Entity.
@@ -298,9 +833,10 @@ namespace secs
 		/**
 		 * \brief Searches for the corresponding Entity
 		 *
-		 * This function searches for the Entity with the passed uid. Due to the huge amount of different containers which
-		 * have to be searched, this is a quite expensive operation and should therefore be avoided if not necessary. Cache
-		 * pointers or references instead.
+		 * This function searches for the Entity with the passed uid, regardless of its current state. The lookup is lock-free and
+		 * thus may be performed from multiple threads, even concurrently to Entity creation and the World's postUpdate. Entities are not
+		 * destructed or recycled immediately after their removal, thus a found Entity stays valid until the second postUpdate after the
+		 * one which removed it. Its Components may already be destructed by then.
 		 * \throws EntityError if corresponding Entity could not be found.
 		 * \param uid Entity Uid
 		 * \return Reference to the corresponding Entity.
@@ -327,20 +863,40 @@ namespace secs
 		 */
 		void preUpdate() noexcept
 		{
-			for (auto& storage : m_Systems)
-				storage.system->preUpdate();
+			runSystems(
+						[frameIndex = m_FrameIndex](SystemStorage& storage)
+						{
+							if (storage.ordering.ticksAt(frameIndex))
+								storage.system->preUpdate();
+						}
+					);
 		}
 
 		/**
 		 * \brief Updates all Systems
 		 *
-		 * This function calls the update functions of every registered System.
+		 * This function calls the update functions of every registered System. Afterwards each Task which became ready will be resumed on the calling
+		 * thread.
 		 * \param delta Time delta between the previous and current update cycle
 		 */
 		void update(float delta) noexcept
 		{
-			for (auto& storage : m_Systems)
-				storage.system->update(delta);
+			runSystems(
+						[delta, frameIndex = m_FrameIndex](SystemStorage& storage)
+						{
+							storage.accumulatedDelta += delta;
+							if (storage.ordering.ticksAt(frameIndex))
+								storage.system->update(std::exchange(storage.accumulatedDelta, 0.f));
+						}
+					);
+			m_TaskScheduler.update(
+									delta,
+									[this](Uid uid)
+									{
+										const auto* entity = m_EntityTable.find(uid);
+										return !entity || entity->state() == EntityState::teardown;
+									}
+								);
 		}
 
 		/**
@@ -348,15 +904,27 @@ namespace secs
 		 *
 		 * This function calls the postUpdate functions of every registered System, which may be used to perform necessary finalization steps
 		 * for the current update process.
+		 * DoubleBuffered Components are committed last, after Entities have changed their states, thus writes of the state change hooks are
+		 * committed, too.
 		 * \remark In this function Entities with state teardown will be destructed and and other Entities may change their state.
 		 */
 		void postUpdate()
 		{
 			postUpdateSystems();
+			collectObserverChanges();
+			for (auto& query : m_Queries | std::views::values)
+				query->collectChanges();
 
+			processEnableRequests();
 			processInitializingEntities();
 			processNewEntities();
 			processEntityDestruction();
+			for (auto index : m_SystemOrder)
+				m_Systems[index].system->endFrame();
+
+			collectErasedEntities();
+			m_EntityTable.collectGarbage();
+			++m_FrameIndex;
 		}
 
 	private:
@@ -365,22 +933,76 @@ namespace secs
 			std::type_index type;
 			std::type_index componentType;
 			std::unique_ptr<ISystem> system;
+			detail::SystemAccess access;
+			detail::SystemOrdering ordering;
+			// indices of succeeding Systems which have to wait for this System
+			std::vector<std::size_t> dependents;
+			std::size_t dependencyCount = 0;
+			// deltas of the frames since the previous update
+			float accumulatedDelta = 0;
 
-			SystemStorage(std::type_index type_, std::type_index componentType_, std::unique_ptr<ISystem> system_) :
+			SystemStorage(
+				std::type_index type_,
+				std::type_index componentType_,
+				std::unique_ptr<ISystem> system_,
+				detail::SystemAccess access_,
+				detail::SystemOrdering ordering_
+			) :
 				type{ type_ },
 				componentType{ componentType_ },
-				system{ std::move(system_) }
+				system{ std::move(system_) },
+				access{ std::move(access_) },
+				ordering{ std::move(ordering_) }
 			{
 				assert(system != nullptr);
 			}
 		};
 
+		template <Component... TComponent>
+		detail::EntityPool* findEntityPool() noexcept
+		{
+			if (std::empty(m_EntityPools))
+				return nullptr;
+
+			const auto itr = m_EntityPools.find(typeid(detail::ComponentSignature<std::remove_cvref_t<TComponent>...>));
+			return itr != std::end(m_EntityPools) ? &itr->second : nullptr;
+		}
+
+		template <Component... TComponent>
+		std::unique_ptr<Entity> makeEntity(Uid uid, detail::EntityPool* pool)
+		{
+			auto entity = std::make_unique<Entity>(
+													uid,
+													std::vector<detail::ComponentStorageInfo>{ makeComponentStorageInfo(systemByComponentType<TComponent>())... }
+												);
+			entity->m_Pool = pool;
+			entity->m_EnableRequests = &m_EnableRequests;
+			return entity;
+		}
+
+		static std::unique_ptr<Entity> recycleEntity(detail::EntityPool& pool, Uid uid)
+		{
+			auto entity = std::move(pool.entities.back());
+			pool.entities.pop_back();
+
+			entity->m_Uid = uid;
+			entity->m_State.store(EntityState::none, std::memory_order_relaxed);
+			// recycled Components are activated as enabled
+			entity->m_Enabled = true;
+			for (auto& info : entity->m_ComponentInfos)
+			{
+				assert(isValid(info));
+				info.rtti->recycle(*info.system, info.componentUid, *entity);
+			}
+			return entity;
+		}
+
 		template <class TSystem>
 		detail::ComponentStorageInfo makeComponentStorageInfo(TSystem& system)
 		{
 			auto uid = system.createComponent();
 			using ComponentType = typename TSystem::ComponentType;
-			return { &system, uid, typeid(ComponentType), &detail::componentRtti<ComponentType> };
+			return { &system, uid, typeid(ComponentType), &detail::componentRtti<ComponentType>, system.m_ObservesEntityStates };
 		}
 
 		template <System TSystem, class TWorld>
@@ -405,19 +1027,403 @@ namespace secs
 
 		void postUpdateSystems() noexcept
 		{
+			runSystems(
+						[frameIndex = m_FrameIndex](SystemStorage& storage)
+						{
+							if (storage.ordering.ticksAt(frameIndex))
+								storage.system->postUpdate();
+						}
+					);
+		}
+
+		[[nodiscard]] std::size_t phaseIndex(std::type_index phase) const
+		{
+			if (auto itr = std::ranges::find(m_PhaseOrder, phase); itr != std::end(m_PhaseOrder))
+				return std::distance(std::begin(m_PhaseOrder), itr) + 1;
+			// an unlisted DefaultPhase precedes every other phase
+			if (phase == typeid(DefaultPhase))
+				return 0;
+			using namespace std::string_literals;
+			throw SystemError("Phase not registered: "s + phase.name());
+		}
+
+		void buildSystemSchedule()
+		{
+			const auto systemCount = std::size(m_Systems);
+			std::vector<std::size_t> phaseIndices(systemCount);
+			for (std::size_t i = 0; i < systemCount; ++i)
+				phaseIndices[i] = phaseIndex(m_Systems[i].ordering.phase);
+
+			std::vector<std::vector<std::size_t>> successors(systemCount);
+			std::vector<std::size_t> predecessorCounts(systemCount);
+			auto addConstraint = [&](std::size_t predecessor, std::size_t successor)
+			{
+				if (phaseIndices[successor] < phaseIndices[predecessor])
+				{
+					using namespace std::string_literals;
+					throw SystemError(
+									"System order contradicts phase order: "s + m_Systems[predecessor].type.name() + " -> " +
+									m_Systems[successor].type.name()
+									);
+				}
+				successors[predecessor].emplace_back(successor);
+				++predecessorCounts[successor];
+			};
+
+			for (std::size_t i = 0; i < systemCount; ++i)
+			{
+				auto findIndex = [this](std::type_index type) -> std::optional<std::size_t>
+				{
+					auto itr = std::ranges::find(m_Systems, type, [](const auto& storage) { return storage.type; });
+					return itr != std::end(m_Systems) ? std::optional{ std::distance(std::begin(m_Systems), itr) } : std::nullopt;
+				};
+
+				for (auto type : m_Systems[i].ordering.runBefore)
+				{
+					if (auto index = findIndex(type))
+						addConstraint(i, *index);
+				}
+				for (auto type : m_Systems[i].ordering.runAfter)
+				{
+					if (auto index = findIndex(type))
+						addConstraint(*index, i);
+				}
+			}
+
+			// Topological sort, which prefers earlier phases and then registration order. Constraints never point into a preceding phase,
+			// thus each phase is completely ordered before the next one begins.
+			using Key = std::pair<std::size_t, std::size_t>;
+			std::priority_queue<Key, std::vector<Key>, std::greater<>> candidates;
+			for (std::size_t i = 0; i < systemCount; ++i)
+			{
+				if (predecessorCounts[i] == 0)
+					candidates.emplace(phaseIndices[i], i);
+			}
+
+			std::vector<std::size_t> order;
+			order.reserve(systemCount);
+			while (!std::empty(candidates))
+			{
+				const auto index = candidates.top().second;
+				candidates.pop();
+				order.emplace_back(index);
+				for (auto successor : successors[index])
+				{
+					if (--predecessorCounts[successor] == 0)
+						candidates.emplace(phaseIndices[successor], successor);
+				}
+			}
+
+			if (std::size(order) != systemCount)
+				throw SystemError("System order constraints are cyclic.");
+
+			std::vector<std::vector<std::size_t>> dependents(systemCount);
+			std::vector<std::size_t> dependencyCounts(systemCount);
+			for (std::size_t i = 0; i < systemCount; ++i)
+			{
+				for (std::size_t j = i + 1; j < systemCount; ++j)
+				{
+					const auto predecessor = order[i];
+					const auto successor = order[j];
+					if (phaseIndices[predecessor] != phaseIndices[successor] ||
+						m_Systems[predecessor].access.conflictsWith(m_Systems[successor].access) ||
+						std::ranges::find(successors[predecessor], successor) != std::end(successors[predecessor]))
+					{
+						dependents[predecessor].emplace_back(successor);
+						++dependencyCounts[successor];
+					}
+				}
+			}
+
+			for (std::size_t i = 0; i < systemCount; ++i)
+			{
+				m_Systems[i].dependents = std::move(dependents[i]);
+				m_Systems[i].dependencyCount = dependencyCounts[i];
+			}
+			m_SystemOrder = std::move(order);
+		}
+
+		template <class TAction>
+		void runSystems(TAction action) noexcept
+		{
+			m_RunningSystems.store(true, std::memory_order_relaxed);
+			runSystemsImpl(
+							[this, &action](SystemStorage& storage)
+							{
+								auto& context = detail::currentSystemContext();
+								const auto previousContext = std::exchange(context, { this, &storage.access });
+								action(storage);
+								context = previousContext;
+							}
+						);
+			m_RunningSystems.store(false, std::memory_order_relaxed);
+		}
+
+		template <class TAction>
+		void runSystemsImpl(TAction action) noexcept
+		{
+			if (m_JobSystem.workerCount() == 0 || std::size(m_Systems) < 2)
+			{
+				for (auto index : m_SystemOrder)
+					action(m_Systems[index]);
+				return;
+			}
+
+			// each System is executed as soon as all of its conflicting predecessors are finished
+			std::vector<std::atomic<std::size_t>> pendingDependencies(std::size(m_Systems));
+			for (std::size_t i = 0; i < std::size(m_Systems); ++i)
+				pendingDependencies[i] = m_Systems[i].dependencyCount;
+			std::atomic<std::size_t> remainingSystems{ std::size(m_Systems) };
+
+			auto execute = [&](std::size_t index, const auto& self) -> void
+			{
+				auto& storage = m_Systems[index];
+				action(storage);
+				for (auto dependent : storage.dependents)
+				{
+					if (--pendingDependencies[dependent] == 0)
+						m_JobSystem.submit([dependent, &self] { self(dependent, self); });
+				}
+				--remainingSystems;
+			};
+
+			for (std::size_t i = 0; i < std::size(m_Systems); ++i)
+			{
+				if (m_Systems[i].dependencyCount == 0)
+					m_JobSystem.submit([i, &execute] { execute(i, execute); });
+			}
+			m_JobSystem.waitUntil([&remainingSystems] { return remainingSystems == 0; });
+		}
+
+		template <class... TComponent>
+		[[nodiscard]] bool mayCreateComponents() const noexcept
+		{
+			if (!m_RunningSystems.load(std::memory_order_relaxed))
+				return true;
+
+			const auto& context = detail::currentSystemContext();
+			if (context.world != this)
+				return false;
+
+			auto writes = [&writes = context.access->writes](const std::type_index& type)
+			{
+				return std::ranges::find(writes, type) != std::end(writes);
+			};
+			return context.access->exclusive || (writes(typeid(TComponent)) && ...);
+		}
+
+		// The Components of pooled Entities are released; the Entities return to their pools when they are collected.
+		void recycleTeardownEntities()
+		{
+			if (std::empty(m_EntityPools))
+				return;
+
+			for (auto& entity : m_TeardownEntities)
+			{
+				if (entity->m_Pool)
+				{
+					for (auto& info : entity->m_ComponentInfos)
+					{
+						assert(isValid(info));
+						info.rtti->release(*info.system, info.componentUid);
+					}
+					m_ErasedEntities.emplace_back(std::move(entity));
+				}
+			}
+		}
+
+		// Entities have been erased from the EntityTable before, thus they are collected in sync with its retired pages.
+		void collectErasedEntities()
+		{
+			if (!std::empty(m_CollectableEntities))
+			{
+				std::scoped_lock lock{ m_NewEntityMx };
+				for (auto& entity : m_CollectableEntities)
+				{
+					if (auto* pool = entity->m_Pool)
+						pool->entities.emplace_back(std::move(entity));
+				}
+			}
+			m_CollectableEntities = std::exchange(m_ErasedEntities, {});
+		}
+
+		void finishTeardown() noexcept
+		{
+			m_JobSystem.waitFor(m_TeardownJob);
+			m_TeardownJob = {};
+		}
+
+		// The Components are destructed, but the Entities themselves are kept until they are collected.
+		void destroyTeardownEntities()
+		{
+			finishTeardown();
+			const bool pipelined = m_PipelinedTeardown && !std::empty(m_TeardownEntities);
+			// recycled Entities have already been moved out
+			for (auto& entity : m_TeardownEntities)
+			{
+				if (!entity)
+					continue;
+
+				for (auto& info : entity->m_ComponentInfos)
+				{
+					assert(isValid(info));
+					if (pipelined)
+						info.rtti->retire(*info.system, info.componentUid);
+					else
+						info.rtti->destroy(*info.system, info.componentUid);
+				}
+				entity->m_ComponentInfos.clear();
+				m_ErasedEntities.emplace_back(std::move(entity));
+			}
+			m_TeardownEntities.clear();
+			if (!pipelined)
+				return;
+
+			m_RetiringSystems.clear();
 			for (auto& storage : m_Systems)
-				storage.system->postUpdate();
+				m_RetiringSystems.emplace_back(storage.system.get());
+
+			m_TeardownJob = m_JobSystem.run(
+											[this]
+											{
+												for (auto* system : m_RetiringSystems)
+													system->destroyRetiredComponents();
+											}
+										);
+		}
+
+		[[nodiscard]] static bool observes(const Observer& observer, const Entity& entity) noexcept
+		{
+			auto ownsComponent = [&entity](std::type_index type)
+			{
+				return std::ranges::find(entity.m_ComponentInfos, type, &detail::ComponentStorageInfo::componentTypeIndex) !=
+						std::end(entity.m_ComponentInfos);
+			};
+			return ownsComponent(observer.m_ComponentType) && std::ranges::all_of(observer.m_Filter, ownsComponent);
+		}
+
+		void notifyObservers(ObserverEvent event, const Entity& entity)
+		{
+			for (auto& observer : m_Observers)
+			{
+				if (observer->m_Event == event && observes(*observer, entity))
+					observer->m_Uids.emplace_back(entity.uid());
+			}
+		}
+
+		// Disabled Entities have already been reported as removed, when they have been disabled.
+		void notifyObservers(ObserverEvent event, const std::vector<std::unique_ptr<Entity>>& entities)
+		{
+			if (std::empty(m_Observers))
+				return;
+
+			for (auto& entity : entities)
+			{
+				assert(entity);
+				if (entity->state() == EntityState::running && entity->isEnabled())
+					notifyObservers(event, *entity);
+			}
+		}
+
+		// Groups and ComponentIndices are maintained exactly like Queries
+		template <class TQuery, class... TComponent>
+		TQuery& registerQuery(TypeList<TComponent...>)
+		{
+			auto itr = m_Queries.find(typeid(TQuery));
+			if (itr == std::end(m_Queries))
+			{
+				auto query = std::make_unique<TQuery>(systemByComponentType<std::remove_const_t<TComponent>>()...);
+				itr = m_Queries.emplace(typeid(TQuery), std::move(query)).first;
+				auto insert = [&query = *itr->second](auto& entity)
+				{
+					if (entity->isEnabled())
+						query.insert(*entity);
+				};
+				std::ranges::for_each(m_InitializingEntities, insert);
+				std::ranges::for_each(m_Entities | std::views::values, insert);
+				std::ranges::for_each(m_TeardownEntities, insert);
+			}
+			return static_cast<TQuery&>(*itr->second);
+		}
+
+		void insertIntoQueries(Entity& entity)
+		{
+			for (auto& query : m_Queries | std::views::values)
+				query->insert(entity);
+		}
+
+		void eraseFromQueries(const Entity& entity) noexcept
+		{
+			for (auto& query : m_Queries | std::views::values)
+				query->erase(entity);
+		}
+
+		template <Component TComponent>
+		static void collectChangedComponents(World& world, Observer& observer)
+		{
+			if (auto* system = world.findSystemByComponentType<TComponent>())
+			{
+				observer.m_ChangeVersion = std::as_const(*system).forEachChangedComponent(
+																						observer.m_ChangeVersion,
+																						[&observer](Entity& entity, const TComponent&)
+																						{
+																							if (entity.state() == EntityState::running &&
+																								observes(observer, entity))
+																								observer.m_Uids.emplace_back(entity.uid());
+																						}
+																						);
+			}
+		}
+
+		void collectObserverChanges()
+		{
+			for (auto& observer : m_Observers)
+			{
+				if (observer->m_CollectChanges)
+					observer->m_CollectChanges(*this, *observer);
+			}
 		}
 
-		template <class TContainer>
-		static auto findEntityItr(TContainer& container, Uid uid) noexcept -> decltype(std::begin(container))
+		void processEnableRequests() noexcept
 		{
-			if (auto itr = std::lower_bound(std::begin(container), std::end(container), uid, EntityLessByUid{});
-				itr != std::end(container) && (*itr)->uid() == uid)
+			std::scoped_lock lock{ m_EnableRequests.mx };
+			for (auto uid : m_EnableRequests.uids)
 			{
-				return itr;
+				// the latest requested state wins, thus multiple toggles of the same Entity are harmless
+				if (auto* entity = m_EntityTable.find(uid))
+				{
+					// Groups expect their Components to be enabled, thus they have to be left before disabling and joined after enabling.
+					// Entities which have not been processed yet will be inserted during the initializing stage.
+					// Observers treat disabled Entities like removed ones.
+					if (!entity->isEnabled())
+					{
+						eraseFromQueries(*entity);
+						if (entity->applyEnabled() && entity->state() == EntityState::running)
+							notifyObservers(ObserverEvent::removed, *entity);
+					}
+					else
+					{
+						const auto changed = entity->applyEnabled();
+						if (entity->state() != EntityState::none)
+							insertIntoQueries(*entity);
+						if (changed && entity->state() == EntityState::running)
+							notifyObservers(ObserverEvent::added, *entity);
+					}
+				}
+			}
+			m_EnableRequests.uids.clear();
+		}
+
+		void flushEntityStateChanges(EntityState state)
+		{
+			for (auto& storage : m_Systems)
+			{
+				if (auto& pendingChanges = storage.system->m_PendingStateChanges; !std::empty(pendingChanges))
+				{
+					storage.system->entityStatesChanged(state, pendingChanges);
+					pendingChanges.clear();
+				}
 			}
-			return std::end(container);
 		}
 
 		auto takeDestructibleEntityUIDs() noexcept
@@ -440,7 +1446,10 @@ namespace secs
 			for (auto& entity : m_InitializingEntities)
 			{
 				entity->changeState(EntityState::initializing);
+				if (entity->isEnabled())
+					insertIntoQueries(*entity);
 			}
+			flushEntityStateChanges(EntityState::initializing);
 		}
 
 		void processInitializingEntities()
@@ -450,17 +1459,29 @@ namespace secs
 
 			for (auto& entity : m_InitializingEntities)
 				entity->changeState(EntityState::running);
+			flushEntityStateChanges(EntityState::running);
+			notifyObservers(ObserverEvent::added, m_InitializingEntities);
 
-			std::scoped_lock lock{ m_EntityMx };
-			m_Entities.insert(std::end(m_Entities), std::make_move_iterator(std::begin(m_InitializingEntities)), std::make_move_iterator(std::end(m_InitializingEntities)));
+			m_Entities.reserve(std::size(m_Entities) + std::size(m_InitializingEntities));
+			for (auto& entity : m_InitializingEntities)
+			{
+				const auto uid = entity->uid();
+				m_Entities.emplace(uid, std::move(entity));
+			}
 			m_InitializingEntities.clear();
 		}
 
 		void processEntityDestruction()
 		{
 			assert(std::size(m_TeardownEntities) <= m_EntityCount);
+			for (auto& entity : m_TeardownEntities)
+			{
+				m_EntityTable.erase(entity->uid());
+				eraseFromQueries(*entity);
+			}
 			m_EntityCount -= std::size(m_TeardownEntities);
-			m_TeardownEntities.clear();
+			recycleTeardownEntities();
+			destroyTeardownEntities();
 
 			auto destructibleEntityUIDs = takeDestructibleEntityUIDs();
 			if (std::empty(destructibleEntityUIDs))
@@ -469,47 +1490,104 @@ namespace secs
 			std::sort(std::begin(destructibleEntityUIDs), std::end(destructibleEntityUIDs));
 			destructibleEntityUIDs.erase(std::unique(std::begin(destructibleEntityUIDs), std::end(destructibleEntityUIDs)), std::end(destructibleEntityUIDs));
 
-			std::scoped_lock entityLock{ m_EntityMx, m_NewEntityMx };
+			std::scoped_lock entityLock{ m_NewEntityMx };
+			auto remainingEntityUIDs = std::begin(destructibleEntityUIDs);
+			for (auto uid : destructibleEntityUIDs)
+			{
+				if (auto itr = m_Entities.find(uid); itr != std::end(m_Entities))
+				{
+					m_TeardownEntities.emplace_back(std::move(itr->second));
+					m_Entities.erase(itr);
+				}
+				else
+				{
+					*remainingEntityUIDs++ = uid;
+				}
+			}
+			destructibleEntityUIDs.erase(remainingEntityUIDs, std::end(destructibleEntityUIDs));
+
+			// the stage containers of new and initializing Entities only hold Entities created during the last cycles. Both, the containers
+			// and the remaining uids are sorted, thus each search may continue behind the previous match.
 			auto moveDestructibleEntities = [&teardownEntities = m_TeardownEntities](auto& entityRange, const auto& destructibleIds)
 			{
-				std::set_intersection(
-								std::make_move_iterator(std::begin(entityRange)),
-								std::make_move_iterator(std::end(entityRange)),
-								std::begin(destructibleIds),
-								std::end(destructibleIds),
-								std::back_inserter(teardownEntities),
-								EntityLessByUid{}
-								);
-				entityRange.erase(std::remove(std::begin(entityRange), std::end(entityRange), nullptr), std::end(entityRange));
+				auto first = std::begin(entityRange);
+				bool moved = false;
+				for (auto uid : destructibleIds)
+				{
+					first = std::lower_bound(first, std::end(entityRange), uid, EntityLessByUid{});
+					if (first == std::end(entityRange))
+						break;
+
+					if ((*first)->uid() == uid)
+					{
+						teardownEntities.emplace_back(std::move(*first));
+						++first;
+						moved = true;
+					}
+				}
+
+				if (moved)
+					entityRange.erase(std::remove(std::begin(entityRange), std::end(entityRange), nullptr), std::end(entityRange));
 			};
 
-			moveDestructibleEntities(m_Entities, destructibleEntityUIDs);
-			moveDestructibleEntities(m_InitializingEntities, destructibleEntityUIDs);
-			moveDestructibleEntities(m_NewEntities, destructibleEntityUIDs);
+			if (!std::empty(destructibleEntityUIDs))
+			{
+				moveDestructibleEntities(m_InitializingEntities, destructibleEntityUIDs);
+				moveDestructibleEntities(m_NewEntities, destructibleEntityUIDs);
+			}
 
+			// Entities which are destroyed before they have been running are not reported as removed, because they have never been added
+			notifyObservers(ObserverEvent::removed, m_TeardownEntities);
 			for (auto& entity : m_TeardownEntities)
 			{
 				assert(entity);
 				entity->changeState(EntityState::teardown);
 			}
+			flushEntityStateChanges(EntityState::teardown);
+			m_TaskScheduler.cancel(m_TeardownEntities | std::views::transform([](const auto& entity) { return entity->uid(); }));
 		}
 
 		std::vector<SystemStorage> m_Systems;
+		// indices into m_Systems in order of execution
+		std::vector<std::size_t> m_SystemOrder;
+		std::vector<std::type_index> m_PhaseOrder;
+		std::uint64_t m_FrameIndex = 0;
+		// destructed after the JobSystem, thus running jobs may still refer to suspended Tasks
+		detail::TaskScheduler m_TaskScheduler;
+		JobSystem m_JobSystem;
 
 		std::atomic<std::size_t> m_EntityCount{ 0 };
+		std::atomic<bool> m_RunningSystems{ false };
 		Uid m_NextUID = 1;
 		mutable std::mutex m_NewEntityMx;
 		std::vector<std::unique_ptr<Entity>> m_NewEntities;
 
 		std::vector<std::unique_ptr<Entity>> m_InitializingEntities;
 
-		mutable std::mutex m_EntityMx;
-		std::vector<std::unique_ptr<Entity>> m_Entities;
+		std::unordered_map<Uid, std::unique_ptr<Entity>> m_Entities;
+		detail::EntityTable m_EntityTable;
 
 		mutable std::mutex m_DestructibleEntityMx;
 		std::vector<Uid> m_DestructibleEntities;
 
 		std::vector<std::unique_ptr<Entity>> m_TeardownEntities;
+
+		// Entities erased from the EntityTable during the current and the previous postUpdate; readers may still refer to them
+		std::vector<std::unique_ptr<Entity>> m_ErasedEntities;
+		std::vector<std::unique_ptr<Entity>> m_CollectableEntities;
+
+		bool m_PipelinedTeardown = false;
+		// owned by the teardown job while it is pending
+		std::vector<ISystem*> m_RetiringSystems;
+		JobHandle m_TeardownJob;
+
+		// guarded by m_NewEntityMx
+		std::unordered_map<std::type_index, detail::EntityPool> m_EntityPools;
+
+		detail::EnableRequestQueue m_EnableRequests;
+		std::unordered_map<std::type_index, std::unique_ptr<detail::QueryBase>> m_Queries;
+
+		std::vector<std::unique_ptr<Observer>> m_Observers;
 	};
 }
 
@@ -8,7 +8,15 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <execution>
+#include <mutex>
+#include <vector>
+
 #include "Simple-ECS/System.hpp"
+#include "Simple-ECS/World.hpp"
 
 namespace secs::test
 {
@@ -61,6 +69,427 @@ namespace secs::test
 	{
 	public:
 	};
+
+	struct LifecycleComponent
+	{
+		int stateChanges = 0;
+	};
+
+	class LifecycleSystem final :
+		public SystemBase<LifecycleComponent>
+	{
+	public:
+		struct Batch
+		{
+			EntityState state;
+			std::size_t size;
+		};
+
+		std::vector<Batch> batches;
+
+	protected:
+		void derivedEntityStatesChanged(EntityState state, std::span<const ComponentEntityPair> changes) override
+		{
+			batches.emplace_back(state, std::size(changes));
+			for (auto& [component, entity] : changes)
+			{
+				assert(entity.state() == state);
+				++component.stateChanges;
+			}
+		}
+	};
+
+	struct Lifecycle2Component
+	{
+		EntityState lastState = EntityState::none;
+	};
+
+	class Lifecycle2System final :
+		public SystemBase<Lifecycle2Component>
+	{
+	protected:
+		void derivedEntityStateChanged(Lifecycle2Component& component, Entity& entity) override
+		{
+			component.lastState = entity.state();
+		}
+	};
+
+	struct ProducerComponent
+	{
+		int value = 0;
+	};
+
+	class ProducerSystem final :
+		public SystemBase<ProducerComponent>
+	{
+	public:
+		using WriteAccess = TypeList<ProducerComponent>;
+
+		void update(float delta) override
+		{
+			forEachComponent([](Entity& entity, ProducerComponent& component) { ++component.value; });
+		}
+	};
+
+	struct ConsumerComponent
+	{
+		int value = 0;
+		int mismatches = 0;
+	};
+
+	class ConsumerSystem final :
+		public SystemBase<ConsumerComponent>
+	{
+	public:
+		using ReadAccess = TypeList<ProducerComponent>;
+		using WriteAccess = TypeList<ConsumerComponent>;
+
+		void update(float delta) override
+		{
+			forEachComponent(
+							[](Entity& entity, ConsumerComponent& component)
+							{
+								const auto producedValue = entity.component<ProducerComponent>().value;
+								if (producedValue != component.value + 1)
+									++component.mismatches;
+								component.value = producedValue;
+							}
+							);
+		}
+	};
+
+	struct ParallelComponent
+	{
+		int value = 0;
+		int visits = 0;
+	};
+
+	class ParallelSystem final :
+		public SystemBase<ParallelComponent>
+	{
+	public:
+		using WriteAccess = TypeList<ParallelComponent>;
+
+		std::size_t grainSize = 16;
+
+		void preUpdate() override
+		{
+			forEachComponent(std::execution::par_unseq, [](Entity& entity, ParallelComponent& component) { component.visits = 0; });
+		}
+
+		void update(float delta) override
+		{
+			parallelForEachComponent(
+									[](Entity& entity, ParallelComponent& component)
+									{
+										++component.visits;
+										component.value = static_cast<int>(entity.uid()) * 2;
+									},
+									grainSize
+									);
+		}
+	};
+
+	struct SpawnComponent
+	{
+		int value = 0;
+	};
+
+	class SpawningSystem final :
+		public SystemBase<SpawnComponent>
+	{
+	public:
+		using WriteAccess = TypeList<SpawnComponent>;
+
+		World* world = nullptr;
+
+		void update(float delta) override
+		{
+			world->createEntity<SpawnComponent>();
+		}
+	};
+
+	struct JobComponent
+	{
+		int value = 0;
+	};
+
+	class JobSpawningSystem final :
+		public SystemBase<JobComponent>
+	{
+	public:
+		using WriteAccess = TypeList<JobComponent>;
+
+		void update(float delta) override
+		{
+			auto& jobs = jobSystem();
+			const auto root = jobs.run(
+										[&](const JobHandle& self)
+										{
+											forEachComponent(
+															[&](Entity& entity, JobComponent& component)
+															{
+																jobs.run(
+																		[&jobs, &component, self]
+																		{
+																			// grand children are also attached to the root
+																			jobs.run([&component] { component.value += 1; }, self);
+																		},
+																		self
+																		);
+															}
+															);
+										}
+										);
+			jobs.waitFor(root);
+		}
+	};
+
+	struct ScriptComponent
+	{
+		int ticks = 0;
+	};
+
+	class ScriptSystem final :
+		public SystemBase<ScriptComponent>
+	{
+	protected:
+		void derivedEntityStateChanged(ScriptComponent& component, Entity& entity) override
+		{
+			if (entity.state() == EntityState::running)
+				startTask(entity, script(component));
+		}
+
+	private:
+		static Task script(ScriptComponent& component)
+		{
+			while (true)
+			{
+				++component.ticks;
+				co_await nextFrame();
+			}
+		}
+	};
+
+	struct InputPhase
+	{
+	};
+
+	struct LatePhase
+	{
+	};
+
+	struct UpdateLog
+	{
+		std::mutex mx;
+		std::vector<int> ids;
+
+		void add(int id)
+		{
+			std::scoped_lock lock{ mx };
+			ids.emplace_back(id);
+		}
+	};
+
+	template <int Id>
+	struct OrderedComponent
+	{
+	};
+
+	template <int Id, class TPhase = DefaultPhase, class TRunBefore = TypeList<>, class TRunAfter = TypeList<>>
+	class OrderedSystem final :
+		public SystemBase<OrderedComponent<Id>>
+	{
+	public:
+		using Phase = TPhase;
+		using RunBefore = TRunBefore;
+		using RunAfter = TRunAfter;
+		// no conflicting accesses, thus the order only depends on phases and constraints
+		using ReadAccess = TypeList<>;
+
+		explicit OrderedSystem(UpdateLog& log) :
+			m_Log{ log }
+		{
+		}
+
+		void update(float delta) override
+		{
+			m_Log.add(Id);
+		}
+
+	private:
+		UpdateLog& m_Log;
+	};
+
+	struct RateComponent
+	{
+		int visits = 0;
+	};
+
+	class RateSystem final :
+		public SystemBase<RateComponent>
+	{
+	public:
+		static constexpr std::uint64_t tickDivisor = 4;
+		static constexpr std::uint64_t tickOffset = 1;
+
+		std::vector<float> deltas;
+
+		void update(float delta) override
+		{
+			deltas.emplace_back(delta);
+			forEachComponentInBucket(
+									frameIndex() / tickDivisor % 2,
+									2,
+									[](Entity& entity, RateComponent& component) { ++component.visits; }
+									);
+		}
+	};
+
+	struct CountedComponent
+	{
+		inline static std::atomic<int> instanceCount{ 0 };
+
+		std::vector<int> payload = std::vector<int>(16);
+
+		CountedComponent() noexcept
+		{
+			++instanceCount;
+		}
+
+		CountedComponent(const CountedComponent& other) :
+			payload{ other.payload }
+		{
+			++instanceCount;
+		}
+
+		CountedComponent(CountedComponent&& other) noexcept :
+			payload{ std::move(other.payload) }
+		{
+			++instanceCount;
+		}
+
+		CountedComponent& operator =(const CountedComponent&) = default;
+		CountedComponent& operator =(CountedComponent&&) noexcept = default;
+
+		~CountedComponent() noexcept
+		{
+			--instanceCount;
+		}
+	};
+
+	class CountedSystem final :
+		public SystemBase<CountedComponent>
+	{
+	};
+
+	struct Cell
+	{
+		std::uint64_t value = 0;
+	};
+
+	class CellSystem final :
+		public SystemBase<DoubleBuffered<Cell>>
+	{
+	public:
+		using ReadAccess = TypeList<Previous<Cell>>;
+		using WriteAccess = TypeList<Next<Cell>>;
+
+		void preUpdate() override
+		{
+			m_PreviousSum = 0;
+			for (auto& cell : components())
+				m_PreviousSum += cell.previous().value;
+		}
+
+		void update(float delta) override
+		{
+			// each cell depends on the previous state of all cells
+			parallelForEachComponent(
+									[previousSum = m_PreviousSum](Entity& entity, DoubleBuffered<Cell>& cell)
+									{
+										cell.next().value = cell.previous().value * 3 + previousSum % 7 + 1;
+									},
+									8
+									);
+		}
+
+	private:
+		std::uint64_t m_PreviousSum = 0;
+	};
+
+	struct CellObserverComponent
+	{
+	};
+
+	class CellObserverSystem final :
+		public SystemBase<CellObserverComponent>
+	{
+	public:
+		using ReadAccess = TypeList<Previous<Cell>>;
+
+		explicit CellObserverSystem(const CellSystem& cellSystem) :
+			m_CellSystem{ cellSystem }
+		{
+		}
+
+		std::vector<std::uint64_t> sums;
+
+		void update(float delta) override
+		{
+			std::uint64_t sum = 0;
+			for (auto& cell : m_CellSystem.components())
+				sum += cell.previous().value;
+			sums.emplace_back(sum);
+		}
+
+	private:
+		const CellSystem& m_CellSystem;
+	};
+
+	struct Health
+	{
+		int value = 100;
+	};
+
+	class HealthSystem final :
+		public SystemBase<Health>
+	{
+	public:
+		// damages every second Component; reading all of them must not count as change
+		void update(float delta) override
+		{
+			auto view = components();
+			for (std::size_t i = 0; i < std::size(view); i += 2)
+				view[i].value -= 1;
+
+			int sum = 0;
+			std::as_const(*this).forEachComponent([&sum](Entity&, const Health& health) { sum += health.value; });
+			healthSum = sum;
+		}
+
+		int healthSum = 0;
+	};
+
+	struct Position
+	{
+		std::array<float, 3> value{};
+	};
+
+	class PositionSystem final :
+		public SystemBase<Position>
+	{
+	};
+
+	struct Team
+	{
+		int id = 0;
+	};
+
+	class TeamSystem final :
+		public SystemBase<Team>
+	{
+	};
 }
 
 #endif
@@ -3,8 +3,20 @@
 //    (See accompanying file LICENSE_1_0.txt or copy at
 //          https://www.boost.org/LICENSE_1_0.txt)
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <execution>
+#include <numeric>
+#include <limits>
 #include <optional>
+#include <thread>
+#include <vector>
 
+#include "Simple-ECS/Broadphase.hpp"
+#include "Simple-ECS/ComponentIndex.hpp"
+#include "Simple-ECS/SpatialGrid.hpp"
+#include "Simple-ECS/TickDriver.hpp"
 #include "Simple-ECS/World.hpp"
 
 #include "catch.hpp"
@@ -169,3 +181,1469 @@ TEST_CASE("World system managing tests", "[World]")
 		REQUIRE_THROWS(std::as_const(testSystem).component(std::numeric_limits<secs::Uid>::max()));
 	}
 }
+
+TEST_CASE("World entity destruction in different stages", "[World]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+
+	std::vector<secs::Uid> runningUids;
+	for (int i = 0; i < 10; ++i)
+		runningUids.emplace_back(localWorld.createEntity<TestComponent>().uid());
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	const auto initializingUid = localWorld.createEntity<TestComponent>().uid();
+	localWorld.postUpdate();
+	const auto newUid = localWorld.createEntity<TestComponent>().uid();
+	REQUIRE(localWorld.entityCount() == 12);
+	REQUIRE(localWorld.entity(initializingUid).state() == secs::EntityState::initializing);
+	REQUIRE(localWorld.entity(newUid).state() == secs::EntityState::none);
+
+	localWorld.destroyEntityLater(runningUids[3]);
+	localWorld.destroyEntityLater(runningUids[7]);
+	localWorld.destroyEntityLater(runningUids[7]);
+	localWorld.destroyEntityLater(initializingUid);
+	localWorld.destroyEntityLater(newUid);
+	localWorld.destroyEntityLater(std::numeric_limits<secs::Uid>::max());
+	localWorld.postUpdate();
+
+	REQUIRE(localWorld.entityCount() == 12);
+	for (auto uid : { runningUids[3], runningUids[7], initializingUid, newUid })
+	{
+		auto* entity = localWorld.findEntity(uid);
+		REQUIRE(entity != nullptr);
+		REQUIRE(entity->state() == secs::EntityState::teardown);
+	}
+	REQUIRE(localWorld.entity(runningUids[0]).state() == secs::EntityState::running);
+
+	localWorld.postUpdate();
+	REQUIRE(localWorld.entityCount() == 8);
+	REQUIRE(localWorld.system<TestSystem>().size() == 8);
+	for (auto uid : { runningUids[3], runningUids[7], initializingUid, newUid })
+		REQUIRE(localWorld.findEntity(uid) == nullptr);
+	for (auto uid : { runningUids[0], runningUids[4], runningUids[9] })
+		REQUIRE(localWorld.findEntity(uid) != nullptr);
+}
+
+TEST_CASE("World entity lookup over multiple table pages", "[World]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+
+	constexpr std::size_t entityCount = 3 * secs::detail::EntityTable::pageSize;
+	std::vector<secs::Uid> uids;
+	for (std::size_t i = 0; i < entityCount; ++i)
+		uids.emplace_back(localWorld.createEntity<TestComponent>().uid());
+
+	for (auto uid : uids)
+		REQUIRE(localWorld.findEntity(uid)->uid() == uid);
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	REQUIRE(localWorld.entity(uids.back()).state() == secs::EntityState::running);
+
+	for (auto uid : uids)
+		localWorld.destroyEntityLater(uid);
+	localWorld.postUpdate();
+	REQUIRE(localWorld.findEntity(uids.front())->state() == secs::EntityState::teardown);
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	REQUIRE(localWorld.entityCount() == 0);
+	for (auto uid : uids)
+		REQUIRE(localWorld.findEntity(uid) == nullptr);
+
+	const auto& entity = localWorld.createEntity<TestComponent>();
+	REQUIRE(localWorld.findEntity(entity.uid()) == &entity);
+}
+
+TEST_CASE("World entity lookup concurrently to postUpdate", "[World]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+	localWorld.enableEntityRecycling<TestComponent>();
+
+	std::atomic<secs::Uid> maxUid{ 0 };
+	std::atomic<std::size_t> passCount{ 0 };
+	std::atomic<bool> done{ false };
+	std::size_t foundCount = 0;
+	std::size_t mismatchCount = 0;
+	std::thread reader{
+		[&]
+		{
+			std::vector<std::pair<secs::Uid, const secs::Entity*>> found;
+			while (!done)
+			{
+				// the Entities are read after all lookups, thus postUpdate will probably remove some of them in between
+				found.clear();
+				for (secs::Uid uid = 1, last = maxUid; uid <= last; ++uid)
+				{
+					if (const auto* entity = localWorld.findEntity(uid))
+						found.emplace_back(uid, entity);
+				}
+				for (auto [uid, entity] : found)
+				{
+					if (entity->uid() != uid)
+						++mismatchCount;
+				}
+				foundCount += std::size(found);
+				++passCount;
+			}
+		}
+	};
+
+	std::vector<secs::Uid> uids;
+	for (int frame = 0; frame < 200; ++frame)
+	{
+		localWorld.postUpdate();
+		// recycles Entities, which have been removed by a previous postUpdate
+		for (int i = 0; i < 20; ++i)
+			uids.emplace_back(localWorld.createEntity<TestComponent>().uid());
+		maxUid = uids.back();
+		for (std::size_t i = 0; i < std::size(uids); i += 2)
+			localWorld.destroyEntityLater(uids[i]);
+		std::erase_if(uids, [i = std::size_t{ 0 }](secs::Uid) mutable { return i++ % 2 == 0; });
+
+		// readers have to finish their lookups within one update cycle
+		for (const auto target = passCount + 2; passCount < target;)
+			std::this_thread::yield();
+	}
+	done = true;
+	reader.join();
+
+	REQUIRE(0 < foundCount);
+	REQUIRE(mismatchCount == 0);
+	for (auto uid : uids)
+		REQUIRE(localWorld.findEntity(uid)->uid() == uid);
+}
+
+TEST_CASE("System receives batched entity state changes", "[System]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+	auto& lifecycleSystem = localWorld.registerSystem<LifecycleSystem>();
+
+	std::vector<secs::Entity*> entities;
+	for (int i = 0; i < 5; ++i)
+		entities.emplace_back(&localWorld.createEntity<TestComponent, LifecycleComponent>());
+	localWorld.createEntity<TestComponent>();
+
+	localWorld.postUpdate();
+	REQUIRE(std::size(lifecycleSystem.batches) == 1);
+	REQUIRE(lifecycleSystem.batches[0].state == secs::EntityState::initializing);
+	REQUIRE(lifecycleSystem.batches[0].size == 5);
+
+	localWorld.postUpdate();
+	REQUIRE(std::size(lifecycleSystem.batches) == 2);
+	REQUIRE(lifecycleSystem.batches[1].state == secs::EntityState::running);
+	REQUIRE(lifecycleSystem.batches[1].size == 5);
+
+	localWorld.destroyEntityLater(entities[1]->uid());
+	localWorld.destroyEntityLater(entities[3]->uid());
+	localWorld.postUpdate();
+	REQUIRE(std::size(lifecycleSystem.batches) == 3);
+	REQUIRE(lifecycleSystem.batches[2].state == secs::EntityState::teardown);
+	REQUIRE(lifecycleSystem.batches[2].size == 2);
+	REQUIRE(entities[1]->component<LifecycleComponent>().stateChanges == 3);
+	REQUIRE(entities[0]->component<LifecycleComponent>().stateChanges == 2);
+
+	localWorld.postUpdate();
+	REQUIRE(std::size(lifecycleSystem.batches) == 3);
+	REQUIRE(lifecycleSystem.size() == 3);
+}
+
+TEST_CASE("System state change hooks are detected during registration", "[System]")
+{
+	static_assert(!secs::SystemBase<TestComponent>::observesEntityStates<TestSystem>());
+	static_assert(secs::SystemBase<Lifecycle2Component>::observesEntityStates<Lifecycle2System>());
+
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+	localWorld.registerSystem<Lifecycle2System>();
+
+	auto& entity = localWorld.createEntity<TestComponent, Lifecycle2Component>();
+	REQUIRE(entity.component<Lifecycle2Component>().lastState == secs::EntityState::none);
+	localWorld.postUpdate();
+	REQUIRE(entity.component<Lifecycle2Component>().lastState == secs::EntityState::initializing);
+	localWorld.postUpdate();
+	REQUIRE(entity.component<Lifecycle2Component>().lastState == secs::EntityState::running);
+	localWorld.destroyEntityLater(entity.uid());
+	localWorld.postUpdate();
+	REQUIRE(entity.component<Lifecycle2Component>().lastState == secs::EntityState::teardown);
+}
+
+TEST_CASE("World recycles Entities with enabled signatures", "[World]")
+{
+	secs::World localWorld;
+	auto& testSystem = localWorld.registerSystem<TestSystem>();
+	auto& lifecycleSystem = localWorld.registerSystem<LifecycleSystem>();
+	localWorld.enableEntityRecycling<TestComponent, LifecycleComponent>();
+
+	auto& entity = localWorld.createEntity<TestComponent, LifecycleComponent>();
+	auto& otherEntity = localWorld.createEntity<LifecycleComponent, TestComponent>();
+	const auto firstUid = entity.uid();
+	const auto* firstComponent = &entity.component<TestComponent>();
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	REQUIRE(entity.component<TestComponent>().data == 8);
+
+	localWorld.destroyEntityLater(entity.uid());
+	localWorld.destroyEntityLater(otherEntity.uid());
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	REQUIRE(localWorld.entityCount() == 0);
+	REQUIRE(testSystem.empty());
+	REQUIRE(lifecycleSystem.empty());
+	REQUIRE(localWorld.findEntity(firstUid) == nullptr);
+
+	// removed Entities are kept for concurrent readers, until the second postUpdate after their removal
+	REQUIRE(entity.state() == secs::EntityState::teardown);
+	localWorld.postUpdate();
+	REQUIRE(entity.uid() == firstUid);
+	localWorld.postUpdate();
+
+	REQUIRE(testSystem.findComponent(1) == nullptr);
+	REQUIRE(!testSystem.hasComponent(1));
+
+	auto& recycledEntity = localWorld.createEntity<TestComponent, LifecycleComponent>();
+	REQUIRE(&recycledEntity == &entity);
+	REQUIRE(recycledEntity.uid() != firstUid);
+	REQUIRE(recycledEntity.state() == secs::EntityState::none);
+	REQUIRE(&recycledEntity.component<TestComponent>() == firstComponent);
+	REQUIRE(recycledEntity.component<TestComponent>().data == 0);
+	REQUIRE(recycledEntity.component<LifecycleComponent>().stateChanges == 0);
+	REQUIRE(localWorld.findEntity(recycledEntity.uid()) == &recycledEntity);
+	REQUIRE(testSystem.size() == 1);
+	REQUIRE(lifecycleSystem.size() == 1);
+
+	localWorld.postUpdate();
+	REQUIRE(recycledEntity.state() == secs::EntityState::initializing);
+	REQUIRE(recycledEntity.component<LifecycleComponent>().stateChanges == 1);
+
+	auto& newEntity = localWorld.createEntity<TestComponent, LifecycleComponent>();
+	REQUIRE(&newEntity != &recycledEntity);
+	REQUIRE(testSystem.size() == 2);
+}
+
+TEST_CASE("World updates Systems in parallel while respecting conflicting accesses", "[World]")
+{
+	secs::World localWorld{ 4 };
+	auto& testSystem = localWorld.registerSystem<TestSystem>();
+	auto& producerSystem = localWorld.registerSystem<ProducerSystem>();
+	auto& consumerSystem = localWorld.registerSystem<ConsumerSystem>();
+
+	for (int i = 0; i < 100; ++i)
+		localWorld.createEntity<ProducerComponent, ConsumerComponent>();
+	auto& testEntity = localWorld.createEntity<TestComponent>();
+
+	for (int i = 0; i < 50; ++i)
+	{
+		localWorld.preUpdate();
+		localWorld.update(0);
+		localWorld.postUpdate();
+	}
+
+	REQUIRE(testEntity.component<TestComponent>().data == 50 * 7);
+	REQUIRE(producerSystem.size() == 100);
+	REQUIRE(consumerSystem.size() == 100);
+	for (secs::Uid uid = 1; uid <= 100; ++uid)
+	{
+		REQUIRE(producerSystem.component(uid).value == 50);
+		REQUIRE(consumerSystem.component(uid).value == 50);
+		REQUIRE(consumerSystem.component(uid).mismatches == 0);
+	}
+	REQUIRE(testSystem.size() == 1);
+}
+
+TEST_CASE("Systems create Entities with declared write access during parallel updates", "[World]")
+{
+	secs::World localWorld{ 4 };
+	localWorld.registerSystem<ProducerSystem>();
+	localWorld.registerSystem<ConsumerSystem>();
+	auto& spawningSystem = localWorld.registerSystem<SpawningSystem>();
+	spawningSystem.world = &localWorld;
+
+	for (int i = 0; i < 100; ++i)
+		localWorld.createEntity<ProducerComponent, ConsumerComponent>();
+
+	for (int i = 0; i < 20; ++i)
+	{
+		localWorld.preUpdate();
+		localWorld.update(0);
+		localWorld.postUpdate();
+	}
+
+	REQUIRE(spawningSystem.size() == 20);
+	REQUIRE(localWorld.entityCount() == 120);
+}
+
+TEST_CASE("JobSystem executes jobs while waiting", "[JobSystem]")
+{
+	const std::size_t workerCount = GENERATE(0, 1, 4);
+	secs::JobSystem jobSystem{ workerCount };
+	REQUIRE(jobSystem.workerCount() == workerCount);
+
+	std::atomic<int> counter{ 0 };
+	for (int i = 0; i < 1000; ++i)
+		jobSystem.submit([&counter] { ++counter; });
+	jobSystem.waitUntil([&counter] { return counter == 1000; });
+	REQUIRE(counter == 1000);
+}
+
+TEST_CASE("System processes Components in parallel", "[System]")
+{
+	const std::size_t workerCount = GENERATE(0, 3);
+	secs::World localWorld{ workerCount };
+	auto& parallelSystem = localWorld.registerSystem<ParallelSystem>();
+	parallelSystem.grainSize = GENERATE(1, 7, 10000);
+
+	std::vector<secs::Uid> uids;
+	for (int i = 0; i < 1000; ++i)
+		uids.emplace_back(localWorld.createEntity<ParallelComponent>().uid());
+	// produces some holes
+	for (std::size_t i = 0; i < std::size(uids); i += 3)
+		localWorld.destroyEntityLater(uids[i]);
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	localWorld.update(0);
+	for (std::size_t i = 0; i < std::size(uids); ++i)
+	{
+		if (auto* entity = localWorld.findEntity(uids[i]))
+		{
+			REQUIRE(i % 3 != 0);
+			const auto& component = entity->component<ParallelComponent>();
+			REQUIRE(component.visits == 1);
+			REQUIRE(component.value == static_cast<int>(uids[i]) * 2);
+		}
+		else
+		{
+			REQUIRE(i % 3 == 0);
+		}
+	}
+}
+
+TEST_CASE("System exposes its active Components as random access views", "[System]")
+{
+	secs::World localWorld;
+	auto& parallelSystem = localWorld.registerSystem<ParallelSystem>();
+
+	std::vector<secs::Uid> uids;
+	for (int i = 0; i < 500; ++i)
+		uids.emplace_back(localWorld.createEntity<ParallelComponent>().uid());
+	for (std::size_t i = 0; i < std::size(uids); i += 2)
+		localWorld.destroyEntityLater(uids[i]);
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	localWorld.preUpdate();
+	localWorld.update(0);
+
+	auto components = parallelSystem.components();
+	auto entities = parallelSystem.entities();
+	static_assert(std::ranges::random_access_range<decltype(components)>);
+	static_assert(std::ranges::sized_range<decltype(components)>);
+	static_assert(std::same_as<std::ranges::range_reference_t<decltype(entities)>, secs::Entity&>);
+	static_assert(std::same_as<std::ranges::range_reference_t<decltype(std::as_const(parallelSystem).entities())>, const secs::Entity&>);
+	REQUIRE(std::ranges::size(components) == 250);
+	REQUIRE(std::ranges::size(entities) == 250);
+	for (std::size_t i = 0; i < std::size(components); ++i)
+	{
+		REQUIRE(&components[i] == &entities[i].component<ParallelComponent>());
+		REQUIRE(components[i].visits == 1);
+	}
+
+	std::transform(
+					std::execution::par,
+					std::begin(components),
+					std::end(components),
+					std::begin(components),
+					[](ParallelComponent component)
+					{
+						component.value = 1;
+						return component;
+					}
+				);
+	const auto sum = std::transform_reduce(
+											std::execution::par_unseq,
+											std::begin(components),
+											std::end(components),
+											0,
+											std::plus<>{},
+											[](const ParallelComponent& component) { return component.value; }
+										);
+	REQUIRE(sum == 250);
+
+	const auto& constSystem = std::as_const(parallelSystem);
+	REQUIRE(std::ranges::all_of(constSystem.components(), [](const ParallelComponent& component) { return component.value == 1; }));
+
+	localWorld.preUpdate();
+	REQUIRE(std::ranges::all_of(components, [](const ParallelComponent& component) { return component.visits == 0; }));
+}
+
+TEST_CASE("JobSystem tracks parent and child jobs", "[JobSystem]")
+{
+	const std::size_t workerCount = GENERATE(0, 2);
+	secs::JobSystem jobSystem{ workerCount };
+
+	REQUIRE(secs::JobHandle{}.finished());
+
+	std::atomic<int> counter{ 0 };
+	std::atomic<bool> release{ workerCount == 0 };
+	const auto parent = jobSystem.run(
+									[&](const secs::JobHandle& self)
+									{
+										++counter;
+										for (int i = 0; i < 10; ++i)
+										{
+											jobSystem.run(
+														[&, self]
+														{
+															for (int j = 0; j < 10; ++j)
+																jobSystem.run([&counter] { ++counter; }, self);
+															while (!release)
+																std::this_thread::yield();
+															++counter;
+														},
+														self
+														);
+										}
+									}
+									);
+	if (workerCount != 0)
+		REQUIRE(!parent.finished());
+	release = true;
+	jobSystem.waitFor(parent);
+	REQUIRE(parent.finished());
+	REQUIRE(counter == 111);
+}
+
+TEST_CASE("Systems spawn jobs on the JobSystem of their World", "[System]")
+{
+	const std::size_t workerCount = GENERATE(0, 3);
+	secs::World localWorld{ workerCount };
+	auto& system = localWorld.registerSystem<JobSpawningSystem>();
+	REQUIRE(localWorld.jobSystem().workerCount() == workerCount);
+
+	for (int i = 0; i < 100; ++i)
+		localWorld.createEntity<JobComponent>();
+	localWorld.update(0);
+	localWorld.update(0);
+
+	REQUIRE(std::ranges::all_of(system.components(), [](const JobComponent& component) { return component.value == 2; }));
+}
+
+TEST_CASE("World resumes Tasks during update", "[Task]")
+{
+	secs::World localWorld{ 2 };
+	std::vector<int> events;
+
+	SECTION("Tasks wait for frames")
+	{
+		localWorld.startTask(
+							[](std::vector<int>& events) -> secs::Task
+							{
+								events.emplace_back(1);
+								co_await secs::nextFrame();
+								events.emplace_back(2);
+								co_await secs::frames(0);
+								co_await secs::frames(2);
+								events.emplace_back(3);
+							}(events)
+							);
+		REQUIRE(localWorld.taskCount() == 1);
+		REQUIRE(std::empty(events));
+
+		localWorld.update(0);
+		REQUIRE(events == std::vector{ 1 });
+		localWorld.update(0);
+		REQUIRE(events == std::vector{ 1, 2 });
+		localWorld.update(0);
+		REQUIRE(events == std::vector{ 1, 2 });
+		localWorld.update(0);
+		REQUIRE(events == std::vector{ 1, 2, 3 });
+		REQUIRE(localWorld.taskCount() == 0);
+	}
+
+	SECTION("Tasks wait for the accumulated update delta")
+	{
+		localWorld.startTask(
+							[](std::vector<int>& events) -> secs::Task
+							{
+								co_await secs::delay(1);
+								events.emplace_back(1);
+							}(events)
+							);
+
+		// the delay starts as soon as the Task is resumed for the first time
+		localWorld.update(0.5f);
+		localWorld.update(0.75f);
+		REQUIRE(std::empty(events));
+		localWorld.update(0.25f);
+		REQUIRE(events == std::vector{ 1 });
+	}
+
+	SECTION("Tasks wait for jobs")
+	{
+		std::atomic<bool> release{ false };
+		const auto job = localWorld.jobSystem().run(
+													[&release]
+													{
+														while (!release)
+															std::this_thread::yield();
+													}
+												);
+		localWorld.startTask(
+							[](secs::JobHandle job, std::vector<int>& events) -> secs::Task
+							{
+								co_await job;
+								events.emplace_back(1);
+							}(job, events)
+							);
+
+		localWorld.update(0);
+		localWorld.update(0);
+		REQUIRE(std::empty(events));
+
+		release = true;
+		localWorld.jobSystem().waitFor(job);
+		localWorld.update(0);
+		REQUIRE(events == std::vector{ 1 });
+	}
+
+	SECTION("unfinished Tasks are destroyed along with the World")
+	{
+		localWorld.startTask(
+							[](std::vector<int>& events) -> secs::Task
+							{
+								co_await secs::delay(100);
+								events.emplace_back(1);
+							}(events)
+							);
+		localWorld.update(0);
+		REQUIRE(localWorld.taskCount() == 1);
+	}
+}
+
+TEST_CASE("Entity bound Tasks are cancelled on Entity destruction", "[Task]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<ScriptSystem>();
+
+	auto& entity = localWorld.createEntity<ScriptComponent>();
+	const auto entityUid = entity.uid();
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	REQUIRE(localWorld.taskCount() == 1);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		localWorld.update(0);
+		localWorld.postUpdate();
+	}
+	REQUIRE(entity.component<ScriptComponent>().ticks == 3);
+
+	localWorld.destroyEntityLater(entityUid);
+	localWorld.postUpdate();
+	localWorld.update(0);
+	REQUIRE(localWorld.taskCount() == 0);
+
+	// waiting Tasks release their frames during the teardown, not when they would be resumed
+	auto resource = std::make_shared<int>(0);
+	auto waitingTask = [](std::shared_ptr<int> captured) -> secs::Task
+	{
+		co_await secs::delay(10.f);
+		++*captured;
+	};
+	auto& otherEntity = localWorld.createEntity<ScriptComponent>();
+	localWorld.startTask(otherEntity, waitingTask(resource));
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	localWorld.update(0);
+	REQUIRE(localWorld.taskCount() == 2);
+	REQUIRE(resource.use_count() == 2);
+
+	localWorld.destroyEntityLater(otherEntity.uid());
+	localWorld.postUpdate();
+	REQUIRE(localWorld.taskCount() == 0);
+	REQUIRE(resource.use_count() == 1);
+	REQUIRE(*resource == 0);
+}
+
+TEST_CASE("TickDriver advances the World in fixed steps", "[TickDriver]")
+{
+	using namespace std::chrono_literals;
+
+	secs::World localWorld;
+	secs::TickDriver driver{ localWorld, { .timestep = 10ms, .maxCatchUpSteps = 3 } };
+
+	REQUIRE(driver.advance(5ms) == 0);
+	REQUIRE(driver.alpha() == Approx(0.5f));
+	REQUIRE(driver.advance(20ms) == 2);
+	REQUIRE(driver.alpha() == Approx(0.5f));
+	REQUIRE(driver.statistics().tickCount == 2);
+
+	REQUIRE(driver.advance(100ms) == 3);
+	REQUIRE(driver.statistics().tickCount == 5);
+	REQUIRE(driver.statistics().droppedTickCount == 7);
+	REQUIRE(driver.alpha() == Approx(0.5f));
+
+	int iterations = 0;
+	driver.run(
+				[&] { return iterations < 5; },
+				[&](float alpha)
+				{
+					REQUIRE(0 <= alpha);
+					REQUIRE(alpha < 1);
+					++iterations;
+				}
+			);
+	REQUIRE(iterations == 5);
+	REQUIRE(5 < driver.statistics().tickCount);
+	REQUIRE(driver.statistics().overrunCount <= driver.statistics().tickCount);
+	REQUIRE(driver.statistics().maxSpinDuration <= driver.statistics().totalSpinDuration);
+
+	// sleeps never end early, thus a driver without spin threshold never busy waits
+	secs::TickDriver sleepingDriver{ localWorld, { .timestep = 2ms, .spinThreshold = 0ms } };
+	iterations = 0;
+	sleepingDriver.run([&] { return iterations++ < 3; });
+	REQUIRE(sleepingDriver.statistics().totalSpinDuration == 0ms);
+	REQUIRE(0ms <= sleepingDriver.statistics().maxWakeUpLatency);
+}
+
+TEST_CASE("World orders Systems by phases and constraints", "[World]")
+{
+	using System1 = OrderedSystem<1, LatePhase>;
+	using System2 = OrderedSystem<2>;
+	using System4 = OrderedSystem<4>;
+	using System3 = OrderedSystem<3, secs::DefaultPhase, secs::TypeList<>, secs::TypeList<System4>>;
+	using System5 = OrderedSystem<5, InputPhase>;
+	using System6 = OrderedSystem<6, LatePhase, secs::TypeList<System1>>;
+
+	const std::size_t workerCount = GENERATE(0, 3);
+	secs::World localWorld{ workerCount };
+	UpdateLog log;
+
+	localWorld.setPhaseOrder<InputPhase, secs::DefaultPhase, LatePhase>();
+	localWorld.registerSystem<System1>(log);
+	localWorld.registerSystem<System2>(log);
+	localWorld.registerSystem<System3>(log);
+	localWorld.registerSystem<System4>(log);
+	localWorld.registerSystem<System5>(log);
+	localWorld.registerSystem<System6>(log);
+
+	for (int i = 0; i < 10; ++i)
+	{
+		log.ids.clear();
+		localWorld.update(0);
+
+		auto position = [&ids = log.ids](int id) { return std::ranges::find(ids, id) - std::begin(ids); };
+		REQUIRE(std::size(log.ids) == 6);
+		REQUIRE(position(5) == 0);
+		REQUIRE(position(2) < 4);
+		REQUIRE(position(4) < position(3));
+		REQUIRE(position(3) < 4);
+		REQUIRE(position(6) == 4);
+		REQUIRE(position(1) == 5);
+	}
+
+	SECTION("Systems of unknown phases can not be registered")
+	{
+		using UnknownPhaseSystem = OrderedSystem<7, int>;
+		REQUIRE_THROWS_AS(localWorld.registerSystem<UnknownPhaseSystem>(log), secs::SystemError);
+		REQUIRE(localWorld.findSystem<UnknownPhaseSystem>() == nullptr);
+
+		auto setIncompletePhaseOrder = [&] { localWorld.setPhaseOrder<InputPhase, secs::DefaultPhase>(); };
+		REQUIRE_THROWS_AS(setIncompletePhaseOrder(), secs::SystemError);
+	}
+
+	SECTION("contradicting constraints are rejected")
+	{
+		REQUIRE_NOTHROW(localWorld.registerSystem<OrderedSystem<8, secs::DefaultPhase, secs::TypeList<System3>, secs::TypeList<System2>>>(log));
+
+		using ContradictingSystem = OrderedSystem<9, LatePhase, secs::TypeList<System5>>;
+		REQUIRE_THROWS_AS(localWorld.registerSystem<ContradictingSystem>(log), secs::SystemError);
+		REQUIRE(localWorld.findSystem<ContradictingSystem>() == nullptr);
+
+		using CyclicSystem = OrderedSystem<10, secs::DefaultPhase, secs::TypeList<System4>, secs::TypeList<System3>>;
+		REQUIRE_THROWS_AS(localWorld.registerSystem<CyclicSystem>(log), secs::SystemError);
+	}
+}
+
+TEST_CASE("World updates Systems with tick divisors less frequently", "[World]")
+{
+	secs::World localWorld;
+	auto& system = localWorld.registerSystem<RateSystem>();
+	std::vector<secs::Uid> uids;
+	for (int i = 0; i < 10; ++i)
+		uids.emplace_back(localWorld.createEntity<RateComponent>().uid());
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	REQUIRE(localWorld.frameIndex() == 2);
+
+	for (int i = 0; i < 16; ++i)
+	{
+		localWorld.preUpdate();
+		localWorld.update(1);
+		localWorld.postUpdate();
+	}
+
+	// updated during frames 5, 9, 13 and 17
+	REQUIRE(system.deltas == std::vector<float>{ 4, 4, 4, 4 });
+	REQUIRE(std::ranges::all_of(system.components(), [](const RateComponent& component) { return component.visits == 2; }));
+}
+
+TEST_CASE("World destructs torn down Entities in a pipelined job", "[World]")
+{
+	const std::size_t workerCount = GENERATE(0, 2);
+	{
+		secs::World localWorld{ workerCount };
+		auto& system = localWorld.registerSystem<CountedSystem>();
+		localWorld.setPipelinedTeardown(true);
+		REQUIRE(localWorld.pipelinedTeardown());
+
+		std::vector<secs::Uid> uids;
+		for (int i = 0; i < 100; ++i)
+			uids.emplace_back(localWorld.createEntity<CountedComponent>().uid());
+		localWorld.postUpdate();
+		localWorld.postUpdate();
+		REQUIRE(CountedComponent::instanceCount == 100);
+
+		for (std::size_t i = 0; i < 50; ++i)
+			localWorld.destroyEntityLater(uids[i]);
+		localWorld.postUpdate();
+		REQUIRE(std::size(system.components()) == 100);
+
+		localWorld.postUpdate();
+		REQUIRE(std::size(system.components()) == 50);
+		REQUIRE(localWorld.entityCount() == 50);
+		REQUIRE(localWorld.findEntity(uids[0]) == nullptr);
+
+		localWorld.preUpdate();
+		localWorld.update(0);
+		localWorld.postUpdate();
+		REQUIRE(CountedComponent::instanceCount == 50);
+
+		for (int i = 0; i < 50; ++i)
+			localWorld.createEntity<CountedComponent>();
+		localWorld.postUpdate();
+		REQUIRE(std::size(system.components()) == 100);
+
+		for (std::size_t i = 50; i < 100; ++i)
+			localWorld.destroyEntityLater(uids[i]);
+		localWorld.postUpdate();
+		localWorld.postUpdate();
+	}
+	REQUIRE(CountedComponent::instanceCount == 0);
+}
+
+TEST_CASE("JobSystem places workers on NUMA nodes", "[JobSystem]")
+{
+	const bool pinWorkers = GENERATE(false, true);
+	secs::JobSystem jobSystem{ secs::JobSystemConfig{ .workerCount = 4, .pinWorkers = pinWorkers } };
+	REQUIRE(1 <= jobSystem.nodeCount());
+
+	for (std::size_t i = 0; i < jobSystem.workerCount(); ++i)
+	{
+		std::atomic<bool> executed{ false };
+		jobSystem.waitFor(jobSystem.runOnWorker(i, [&] { executed = true; }));
+		REQUIRE(executed);
+	}
+
+	const auto placements = jobSystem.workerPlacements();
+	REQUIRE(std::size(placements) == 4);
+	for (std::size_t i = 0; i < std::size(placements); ++i)
+	{
+		REQUIRE(placements[i].workerIndex == i);
+		REQUIRE(jobSystem.findWorkerOnNode(placements[i].node).has_value());
+		if (!pinWorkers)
+			REQUIRE(placements[i].assignedCpu == -1);
+		else if (placements[i].assignedCpu != -1 && placements[i].observedCpu != -1)
+			REQUIRE(placements[i].observedCpu == placements[i].assignedCpu);
+	}
+	REQUIRE(!jobSystem.findWorkerOnNode(-1).has_value());
+
+	// invalid cpu indices are rejected instead of being written out of bounds
+	REQUIRE(!secs::detail::pinCurrentThread(-1));
+	REQUIRE(!secs::detail::pinCurrentThread(secs::detail::maxCpuCount));
+}
+
+TEST_CASE("World reserves Component storage on NUMA nodes", "[World]")
+{
+	secs::World localWorld{ secs::JobSystemConfig{ .workerCount = 2 } };
+	auto& system = localWorld.registerSystem<CountedSystem>();
+	const auto node = localWorld.jobSystem().workerPlacements().front().node;
+
+	localWorld.reserveComponents<CountedComponent>(1000, node);
+	REQUIRE(std::empty(system.components()));
+
+	for (int i = 0; i < 1000; ++i)
+		localWorld.createEntity<CountedComponent>();
+	localWorld.postUpdate();
+	REQUIRE(std::size(system.components()) == 1000);
+
+	std::size_t pageCount = 0;
+	for (auto [placementNode, count] : localWorld.componentPlacement<CountedComponent>())
+	{
+		REQUIRE((placementNode == -1 || placementNode == node));
+		pageCount += count;
+	}
+	REQUIRE(0 < pageCount);
+}
+
+TEST_CASE("DoubleBuffered Components are committed at the end of each frame", "[System]")
+{
+	auto simulate = [](std::size_t workerCount)
+	{
+		secs::World localWorld{ workerCount };
+		auto& cellSystem = localWorld.registerSystem<CellSystem>();
+		auto& observerSystem = localWorld.registerSystem<CellObserverSystem>(cellSystem);
+		for (int i = 0; i < 100; ++i)
+			localWorld.createEntity<secs::DoubleBuffered<Cell>>();
+
+		for (int i = 0; i < 10; ++i)
+		{
+			localWorld.preUpdate();
+			localWorld.update(0);
+			localWorld.postUpdate();
+			REQUIRE(std::ranges::all_of(cellSystem.components(), [](const auto& cell) { return cell.previous().value == cell.next().value; }));
+		}
+		return observerSystem.sums;
+	};
+
+	const auto expectedSums = simulate(0);
+	REQUIRE(std::size(expectedSums) == 10);
+	REQUIRE(expectedSums[0] == 0);
+	REQUIRE(expectedSums[1] == 100);
+	REQUIRE(simulate(3) == expectedSums);
+
+	// Entities created during a frame are committed during its postUpdate
+	secs::World localWorld;
+	localWorld.registerSystem<CellSystem>();
+	auto& entity = localWorld.createEntity<secs::DoubleBuffered<Cell>>();
+	entity.component<secs::DoubleBuffered<Cell>>().next().value = 42;
+	localWorld.postUpdate();
+	REQUIRE(std::as_const(entity).component<secs::DoubleBuffered<Cell>>().previous().value == 42);
+}
+
+TEST_CASE("System reports changed Components since a version", "[System]")
+{
+	secs::World localWorld;
+	auto& system = localWorld.registerSystem<HealthSystem>();
+	std::vector<secs::Entity*> entities;
+	for (int i = 0; i < 6; ++i)
+		entities.emplace_back(&localWorld.createEntity<Health>());
+	localWorld.postUpdate();
+
+	auto collectChanges = [&system](std::uint64_t& version)
+	{
+		std::vector<secs::Uid> changedUids;
+		version = system.forEachChangedComponent(version, [&](secs::Entity& entity, const Health&) { changedUids.emplace_back(entity.uid()); });
+		std::ranges::sort(changedUids);
+		return changedUids;
+	};
+
+	// creation counts as change
+	std::uint64_t version = 0;
+	REQUIRE(std::size(collectChanges(version)) == 6);
+	REQUIRE(std::empty(collectChanges(version)));
+
+	localWorld.update(0);
+	REQUIRE(system.healthSum == 6 * 100 - 3);
+	auto changedUids = collectChanges(version);
+	REQUIRE(std::size(changedUids) == 3);
+	for (auto uid : changedUids)
+		REQUIRE(std::as_const(localWorld).findEntity(uid)->component<Health>().value == 99);
+
+	// reading, and any access via the Entity, does not count as change, while mutable access via the System does
+	REQUIRE(std::as_const(*entities[1]).component<Health>().value == 100);
+	REQUIRE(entities[1]->component<Health>().value == 100);
+	REQUIRE(std::empty(collectChanges(version)));
+	entities[1]->componentHandle<Health>()->value = 50;
+	REQUIRE(collectChanges(version) == std::vector{ entities[1]->uid() });
+
+	// observers track their versions independently
+	std::uint64_t otherVersion = 0;
+	REQUIRE(std::size(collectChanges(otherVersion)) == 6);
+	REQUIRE(system.changeVersion() == otherVersion + 1);
+}
+
+TEST_CASE("Observers accumulate matching Entities until drained", "[Observer]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+	localWorld.registerSystem<HealthSystem>();
+	auto& addedObserver = localWorld.observe<secs::Added<Health>, secs::With<TestComponent>>();
+	auto& removedObserver = localWorld.observe<secs::Removed<Health>>();
+	auto& changedObserver = localWorld.observe<secs::Changed<Health>>();
+	REQUIRE(addedObserver.event() == secs::ObserverEvent::added);
+
+	auto& healthyEntity = localWorld.createEntity<Health, TestComponent>();
+	auto& plainEntity = localWorld.createEntity<Health>();
+	localWorld.postUpdate();
+	REQUIRE(addedObserver.empty());
+	localWorld.postUpdate();
+	REQUIRE(addedObserver.drain() == std::vector{ healthyEntity.uid() });
+	REQUIRE(addedObserver.empty());
+	REQUIRE(std::empty(changedObserver.drain()));
+
+	plainEntity.componentHandle<Health>()->value = 1;
+	healthyEntity.componentHandle<Health>()->value = 2;
+	plainEntity.componentHandle<Health>()->value = 3;
+	REQUIRE(changedObserver.empty());
+	localWorld.postUpdate();
+	REQUIRE(changedObserver.drain() == std::vector{ healthyEntity.uid(), plainEntity.uid() });
+	localWorld.postUpdate();
+	REQUIRE(changedObserver.empty());
+
+	// Entities which are destroyed before running are never reported
+	localWorld.destroyEntityLater(localWorld.createEntity<Health>().uid());
+	localWorld.destroyEntityLater(plainEntity.uid());
+	localWorld.postUpdate();
+	REQUIRE(removedObserver.drain() == std::vector{ plainEntity.uid() });
+	REQUIRE(std::as_const(localWorld).findEntity(plainEntity.uid())->state() == secs::EntityState::teardown);
+
+	localWorld.removeObserver(changedObserver);
+	healthyEntity.componentHandle<Health>()->value = 4;
+	localWorld.postUpdate();
+	REQUIRE(addedObserver.empty());
+	REQUIRE(removedObserver.empty());
+}
+
+TEST_CASE("Changed Observers report changes made before the first postUpdate", "[Observer]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<HealthSystem>();
+	auto& entity = localWorld.createEntity<Health>();
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	entity.componentHandle<Health>()->value = 4;
+	auto& observer = localWorld.observe<secs::Changed<Health>>();
+	REQUIRE(observer.empty());
+	entity.componentHandle<Health>()->value = 5;
+	localWorld.postUpdate();
+	REQUIRE(observer.drain() == std::vector{ entity.uid() });
+}
+
+TEST_CASE("Disabled Entities are skipped by their Systems", "[Entity]")
+{
+	secs::World localWorld;
+	auto& system = localWorld.registerSystem<TestSystem>();
+	localWorld.enableEntityRecycling<TestComponent>();
+	std::vector<secs::Entity*> entities;
+	for (int i = 0; i < 5; ++i)
+		entities.emplace_back(&localWorld.createEntity<TestComponent>());
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	entities[1]->setEnabled(false);
+	entities[3]->setEnabled(false);
+	REQUIRE(!entities[1]->isEnabled());
+	// takes effect during postUpdate
+	REQUIRE(system.size() == 5);
+	localWorld.postUpdate();
+	REQUIRE(system.size() == 3);
+	REQUIRE(std::ranges::none_of(system.entities(), [](const secs::Entity& entity) { return !entity.isEnabled(); }));
+
+	std::vector<int> previousData;
+	for (auto* entity : entities)
+		previousData.emplace_back(std::as_const(*entity).component<TestComponent>().data);
+	localWorld.update(0);
+	REQUIRE(entities[0]->component<TestComponent>().data == previousData[0] + 2);
+	REQUIRE(entities[1]->component<TestComponent>().data == previousData[1]);
+	REQUIRE(entities[3]->component<TestComponent>().data == previousData[3]);
+
+	// toggling multiple times within one frame only applies the latest state
+	entities[3]->setEnabled(true);
+	entities[3]->setEnabled(false);
+	entities[3]->setEnabled(true);
+	localWorld.postUpdate();
+	REQUIRE(system.size() == 4);
+
+	// disabled Entities may be destroyed and recycled as enabled Entities
+	localWorld.destroyEntityLater(entities[1]->uid());
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	REQUIRE(system.size() == 4);
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	auto& recycledEntity = localWorld.createEntity<TestComponent>();
+	REQUIRE(&recycledEntity == entities[1]);
+	REQUIRE(recycledEntity.isEnabled());
+	REQUIRE(system.size() == 5);
+}
+
+TEST_CASE("Views join the storages of multiple Systems", "[View]")
+{
+	// rejected by View, because the probe could not tell the storages apart
+	static_assert(!secs::detail::areUnique<Health, Health>);
+	static_assert(secs::detail::areUnique<Health, TestComponent>);
+
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+	auto& healthSystem = localWorld.registerSystem<HealthSystem>();
+	localWorld.registerSystem<CountedSystem>();
+
+	std::vector<secs::Uid> joinedUids;
+	for (int i = 0; i < 10; ++i)
+		localWorld.createEntity<Health>();
+	for (int i = 0; i < 3; ++i)
+		joinedUids.emplace_back(localWorld.createEntity<TestComponent, Health>().uid());
+	const auto excludedUid = localWorld.createEntity<Health, CountedComponent, TestComponent>().uid();
+	localWorld.createEntity<TestComponent>();
+	localWorld.createEntity<CountedComponent>();
+
+	auto view = localWorld.view<TestComponent, const Health>();
+	REQUIRE(view.sizeHint() == 5);
+
+	std::vector<secs::Uid> visitedUids;
+	const auto version = healthSystem.changeVersion();
+	view.forEach(
+				[&](secs::Entity& entity, TestComponent& component, const Health& health)
+				{
+					REQUIRE(health.value == 100);
+					component.data = 42;
+					visitedUids.emplace_back(entity.uid());
+				}
+				);
+	std::ranges::sort(visitedUids);
+	auto expectedUids = joinedUids;
+	expectedUids.emplace_back(excludedUid);
+	REQUIRE(visitedUids == expectedUids);
+	REQUIRE(healthSystem.forEachChangedComponent(version, [](secs::Entity&, const Health&) { FAIL(); }) == version);
+
+	visitedUids.clear();
+	view.without<CountedComponent>().forEach(
+											[&](secs::Entity& entity, TestComponent&, const Health&) { visitedUids.emplace_back(entity.uid()); }
+											);
+	std::ranges::sort(visitedUids);
+	REQUIRE(visitedUids == joinedUids);
+}
+
+TEST_CASE("Queries maintain their matching Entities incrementally", "[Query]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<TestSystem>();
+	auto& healthSystem = localWorld.registerSystem<HealthSystem>();
+	localWorld.registerSystem<CountedSystem>();
+
+	auto& runningEntity = localWorld.createEntity<TestComponent, Health>();
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	using TestQuery = secs::Query<secs::TypeList<TestComponent, const Health>, secs::TypeList<CountedComponent>>;
+	auto& query = localWorld.query<secs::TypeList<TestComponent, const Health>, secs::TypeList<CountedComponent>>();
+	REQUIRE(&query == &localWorld.query<secs::TypeList<TestComponent, const Health>, secs::TypeList<CountedComponent>>());
+	REQUIRE(std::same_as<std::remove_reference_t<decltype(query)>, TestQuery>);
+	REQUIRE(query.size() == 1);
+
+	auto& newEntity = localWorld.createEntity<Health, TestComponent>();
+	localWorld.createEntity<Health, TestComponent, CountedComponent>();
+	localWorld.createEntity<Health>();
+	REQUIRE(query.size() == 1);
+	localWorld.postUpdate();
+	REQUIRE(query.size() == 2);
+
+	const auto version = healthSystem.changeVersion();
+	std::vector<secs::Uid> visitedUids;
+	query.forEach(
+				[&](secs::Entity& entity, TestComponent& component, const Health& health)
+				{
+					REQUIRE(&component == &entity.component<TestComponent>());
+					REQUIRE(health.value == 100);
+					visitedUids.emplace_back(entity.uid());
+				}
+				);
+	std::ranges::sort(visitedUids);
+	REQUIRE(visitedUids == std::vector{ runningEntity.uid(), newEntity.uid() });
+	REQUIRE(healthSystem.forEachChangedComponent(version, [](secs::Entity&, const Health&) { FAIL(); }) == version);
+
+	runningEntity.setEnabled(false);
+	localWorld.postUpdate();
+	REQUIRE(query.size() == 1);
+	REQUIRE(&query.entities()[0] == &newEntity);
+	runningEntity.setEnabled(true);
+	localWorld.postUpdate();
+	REQUIRE(query.size() == 2);
+
+	localWorld.destroyEntityLater(runningEntity.uid());
+	localWorld.postUpdate();
+	REQUIRE(query.size() == 2);
+	localWorld.postUpdate();
+	REQUIRE(query.size() == 1);
+}
+
+TEST_CASE("Owning Groups keep their storages sorted in lockstep", "[Group]")
+{
+	secs::World localWorld;
+	auto& testSystem = localWorld.registerSystem<TestSystem>();
+	auto& healthSystem = localWorld.registerSystem<HealthSystem>();
+	localWorld.registerSystem<CountedSystem>();
+
+	std::vector<secs::Entity*> groupedEntities;
+	for (int i = 0; i < 20; ++i)
+	{
+		localWorld.createEntity<Health>();
+		if (i % 3 == 0)
+			groupedEntities.emplace_back(&localWorld.createEntity<TestComponent, Health>());
+		localWorld.createEntity<TestComponent>();
+	}
+	localWorld.postUpdate();
+
+	auto& group = localWorld.group<TestComponent, const Health>();
+	REQUIRE(&group == &localWorld.group<TestComponent, const Health>());
+	REQUIRE_THROWS_AS((localWorld.group<TestComponent, CountedComponent>()), secs::SystemError);
+
+	auto checkLockstep = [&]
+	{
+		REQUIRE(group.size() == std::size(groupedEntities));
+		for (std::size_t i = 0; i < group.size(); ++i)
+		{
+			auto& entity = testSystem.entities()[i];
+			REQUIRE(&entity == &healthSystem.entities()[i]);
+			REQUIRE(&entity == &group.entities()[i]);
+			REQUIRE(std::ranges::find(groupedEntities, &entity) != std::end(groupedEntities));
+		}
+
+		std::size_t visitCount = 0;
+		group.forEach(
+					[&](secs::Entity& entity, TestComponent& component, const Health& health)
+					{
+						REQUIRE(&component == &std::as_const(entity).component<TestComponent>());
+						REQUIRE(&health == &std::as_const(entity).component<Health>());
+						++visitCount;
+					}
+					);
+		REQUIRE(visitCount == std::size(groupedEntities));
+	};
+	checkLockstep();
+
+	groupedEntities.emplace_back(&localWorld.createEntity<Health, TestComponent, CountedComponent>());
+	localWorld.postUpdate();
+	checkLockstep();
+
+	groupedEntities[2]->setEnabled(false);
+	localWorld.destroyEntityLater(groupedEntities[4]->uid());
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	auto* disabledEntity = groupedEntities[2];
+	auto* destroyedEntity = groupedEntities[4];
+	std::erase(groupedEntities, disabledEntity);
+	std::erase(groupedEntities, destroyedEntity);
+	checkLockstep();
+
+	disabledEntity->setEnabled(true);
+	localWorld.postUpdate();
+	groupedEntities.emplace_back(disabledEntity);
+	checkLockstep();
+}
+
+TEST_CASE("ComponentHandles detect destroyed Components", "[ComponentHandle]")
+{
+	secs::World localWorld;
+	auto& healthSystem = localWorld.registerSystem<HealthSystem>();
+	localWorld.enableEntityRecycling<Health>();
+
+	auto& entity = localWorld.createEntity<Health>();
+	const auto handle = entity.componentHandle<Health>();
+	const secs::ComponentHandle<const Health> constHandle = handle;
+	REQUIRE(handle);
+	REQUIRE(handle == healthSystem.componentHandle(handle.uid()));
+	REQUIRE(&*handle == &std::as_const(entity).component<Health>());
+	REQUIRE(!secs::ComponentHandle<Health>{});
+	REQUIRE(!healthSystem.componentHandle(0));
+
+	auto version = healthSystem.changeVersion();
+	REQUIRE(constHandle->value == 100);
+	version = healthSystem.forEachChangedComponent(version, [](secs::Entity&, const Health&) { FAIL(); });
+	handle->value = 50;
+	REQUIRE(std::as_const(entity).component<Health>().value == 50);
+	bool visited = false;
+	version = healthSystem.forEachChangedComponent(
+													version,
+													[&](secs::Entity& changedEntity, const Health& health)
+													{
+														visited = &changedEntity == &entity && health.value == 50;
+													}
+													);
+	REQUIRE(visited);
+	REQUIRE(version < healthSystem.forEachChangedComponent(version, [](secs::Entity&, const Health&) { FAIL(); }));
+
+	// the recycled Entity reuses the slot, but is a different Component
+	localWorld.destroyEntityLater(entity.uid());
+	localWorld.postUpdate();
+	REQUIRE(handle.isValid());
+	localWorld.postUpdate();
+	REQUIRE(!handle.isValid());
+	REQUIRE(!constHandle);
+	REQUIRE(handle.get() == nullptr);
+
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	auto& recycledEntity = localWorld.createEntity<Health>();
+	REQUIRE(&recycledEntity == &entity);
+	REQUIRE(recycledEntity.componentHandle<const Health>().uid() == handle.uid());
+	REQUIRE(!handle);
+	REQUIRE(recycledEntity.componentHandle<Health>());
+}
+
+TEST_CASE("SpatialGrids index Entity positions incrementally", "[SpatialGrid]")
+{
+	secs::World localWorld{ secs::JobSystemConfig{ .workerCount = 2 } };
+	localWorld.registerSystem<PositionSystem>();
+
+	auto& seededEntity = localWorld.createEntity<Position>();
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+
+	constexpr auto projection = [](const Position& position) { return position.value; };
+	secs::SpatialGrid<Position, decltype(projection)> grid{ localWorld, 10.f, projection };
+	REQUIRE(std::size(grid) == 1);
+	REQUIRE(*grid.findPosition(seededEntity.uid()) == secs::SpatialPosition{});
+
+	std::vector<secs::Entity*> entities;
+	for (int i = 0; i < 20; ++i)
+	{
+		auto& entity = localWorld.createEntity<Position>();
+		entity.component<Position>().value = { static_cast<float>(i) * 5.f, 0.f, 0.f };
+		entities.emplace_back(&entity);
+	}
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	grid.update();
+	REQUIRE(std::size(grid) == 21);
+
+	auto sorted = [](std::vector<secs::Uid> uids)
+	{
+		std::ranges::sort(uids);
+		return uids;
+	};
+	auto uidsOf = [&](std::initializer_list<int> indices)
+	{
+		std::vector<secs::Uid> uids;
+		for (auto index : indices)
+			uids.emplace_back(index < 0 ? seededEntity.uid() : entities[index]->uid());
+		return sorted(uids);
+	};
+
+	std::vector<secs::Uid> result;
+	grid.forEachInRadius({ 50.f, 0.f, 0.f }, 7.f, [&](secs::Uid uid, const secs::SpatialPosition&) { result.emplace_back(uid); });
+	REQUIRE(sorted(result) == uidsOf({ 9, 10, 11 }));
+
+	result.clear();
+	grid.forEachInBox({ -1.f, -1.f, -1.f }, { 12.f, 1.f, 1.f }, [&](secs::Uid uid, const secs::SpatialPosition&) { result.emplace_back(uid); });
+	REQUIRE(sorted(result) == uidsOf({ -1, 0, 1, 2 }));
+
+	REQUIRE(grid.nearest({ 31.f, 0.f, 0.f }, 3) == std::vector{ entities[6]->uid(), entities[7]->uid(), entities[5]->uid() });
+	REQUIRE(std::size(grid.nearest({ 1000.f, 1000.f, 0.f }, 50)) == 21);
+	REQUIRE(grid.nearest({ 1000.f, 1000.f, 0.f }, 1) == std::vector{ entities[19]->uid() });
+
+	// moves are picked up via the change tracking, removals via the teardown
+	entities[10]->componentHandle<Position>()->value = { 0.f, 30.f, 0.f };
+	localWorld.destroyEntityLater(entities[9]->uid());
+	localWorld.postUpdate();
+	grid.update();
+	REQUIRE(std::size(grid) == 20);
+	REQUIRE(grid.findPosition(entities[9]->uid()) == nullptr);
+	REQUIRE(*grid.findPosition(entities[10]->uid()) == secs::SpatialPosition{ 0.f, 30.f, 0.f });
+	REQUIRE(grid.nearest({ 1.f, 28.f, 0.f }, 1) == std::vector{ entities[10]->uid() });
+
+	// disabled Entities leave the grid, toggling within one frame has no effect
+	entities[19]->setEnabled(false);
+	entities[18]->setEnabled(false);
+	entities[18]->setEnabled(true);
+	localWorld.postUpdate();
+	grid.update();
+	REQUIRE(std::size(grid) == 19);
+	REQUIRE(grid.findPosition(entities[19]->uid()) == nullptr);
+	REQUIRE(grid.nearest({ 1000.f, 1000.f, 0.f }, 1) == std::vector{ entities[18]->uid() });
+	REQUIRE(std::size(grid.nearest({ 1000.f, 1000.f, 0.f }, 50)) == 19);
+
+	// enabled and disabled again between two updates
+	entities[19]->setEnabled(true);
+	localWorld.postUpdate();
+	entities[19]->setEnabled(false);
+	localWorld.postUpdate();
+	grid.update();
+	REQUIRE(grid.findPosition(entities[19]->uid()) == nullptr);
+
+	entities[19]->setEnabled(true);
+	localWorld.postUpdate();
+	grid.update();
+	REQUIRE(std::size(grid) == 20);
+	REQUIRE(grid.nearest({ 1000.f, 1000.f, 0.f }, 1) == std::vector{ entities[19]->uid() });
+
+	// large queries neither scale with their volume nor visit aliased cells twice
+	for (const auto radius : { 1'000.f, 1'000'000'000.f })
+	{
+		result.clear();
+		grid.forEachInRadius({}, radius, [&](secs::Uid uid, const secs::SpatialPosition&) { result.emplace_back(uid); });
+		const auto uids = sorted(result);
+		REQUIRE(std::size(uids) == 20);
+		REQUIRE(std::ranges::adjacent_find(uids) == std::end(uids));
+	}
+
+	std::vector<secs::SpatialPosition> centers;
+	for (int i = 0; i < 200; ++i)
+		centers.push_back({ static_cast<float>(i % 20) * 5.f, 0.f, 0.f });
+	std::vector<std::vector<secs::Uid>> batchResults(std::size(centers));
+	grid.batchInRadius(centers, 7.f, batchResults, 8);
+	for (std::size_t i = 0; i < std::size(centers); ++i)
+	{
+		result.clear();
+		grid.forEachInRadius(centers[i], 7.f, [&](secs::Uid uid, const secs::SpatialPosition&) { result.emplace_back(uid); });
+		REQUIRE(sorted(batchResults[i]) == sorted(result));
+	}
+	REQUIRE(sorted(batchResults[50]) == uidsOf({ 11 }));
+}
+
+TEST_CASE("Broadphases report overlapping bounding boxes", "[Broadphase]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<PositionSystem>();
+
+	// unit cubes around the positions
+	constexpr auto projection = [](const Position& position)
+	{
+		const auto& [x, y, z] = position.value;
+		return secs::Aabb{ { x - 1.f, y - 1.f, z - 1.f }, { x + 1.f, y + 1.f, z + 1.f } };
+	};
+	secs::Broadphase<Position, decltype(projection)> broadphase{ localWorld, projection };
+
+	std::vector<secs::Entity*> entities;
+	for (int i = 0; i < 64; ++i)
+	{
+		auto& entity = localWorld.createEntity<Position>();
+		entity.component<Position>().value = { static_cast<float>(i % 16) * 1.5f, static_cast<float>(i / 16) * 3.f, static_cast<float>(i % 3) };
+		entities.emplace_back(&entity);
+	}
+
+	auto expectedPairs = [&]
+	{
+		std::vector<secs::BroadphasePair> pairs;
+		for (std::size_t i = 0; i < std::size(entities); ++i)
+		{
+			for (std::size_t j = i + 1; j < std::size(entities); ++j)
+			{
+				const auto lhs = projection(std::as_const(*entities[i]).component<Position>());
+				const auto rhs = projection(std::as_const(*entities[j]).component<Position>());
+				bool overlaps = true;
+				for (std::size_t axis = 0; axis < 3; ++axis)
+					overlaps = overlaps && lhs.min[axis] <= rhs.max[axis] && rhs.min[axis] <= lhs.max[axis];
+				if (overlaps)
+				{
+					const auto lhsUid = entities[i]->uid();
+					const auto rhsUid = entities[j]->uid();
+					pairs.push_back({ std::min(lhsUid, rhsUid), std::max(lhsUid, rhsUid) });
+				}
+			}
+		}
+		std::ranges::sort(pairs);
+		return pairs;
+	};
+	auto reportedPairs = [&]
+	{
+		std::vector<secs::BroadphasePair> pairs{ std::begin(broadphase.pairs()), std::end(broadphase.pairs()) };
+		std::ranges::sort(pairs);
+		return pairs;
+	};
+
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	broadphase.update();
+	REQUIRE(std::size(broadphase) == 64);
+	REQUIRE(!std::empty(broadphase.pairs()));
+	REQUIRE(reportedPairs() == expectedPairs());
+
+	// move some boxes across the others, which breaks the previous sort order
+	for (std::size_t i = 0; i < std::size(entities); i += 5)
+		entities[i]->componentHandle<Position>()->value[0] = 24.f - entities[i]->component<Position>().value[0];
+	localWorld.destroyEntityLater(entities[7]->uid());
+	localWorld.postUpdate();
+	entities.erase(std::begin(entities) + 7);
+	auto& newEntity = localWorld.createEntity<Position>();
+	newEntity.component<Position>().value = { 3.f, 3.f, 1.f };
+	entities.emplace_back(&newEntity);
+	localWorld.postUpdate();
+	localWorld.postUpdate();
+	broadphase.update();
+	REQUIRE(std::size(broadphase) == 64);
+	REQUIRE(reportedPairs() == expectedPairs());
+
+	// nothing changed
+	broadphase.update();
+	REQUIRE(reportedPairs() == expectedPairs());
+
+	// disabled Entities leave the broadphase
+	auto* disabledEntity = entities.front();
+	disabledEntity->setEnabled(false);
+	entities.erase(std::begin(entities));
+	localWorld.postUpdate();
+	broadphase.update();
+	REQUIRE(std::size(broadphase) == 63);
+	REQUIRE(reportedPairs() == expectedPairs());
+
+	disabledEntity->setEnabled(true);
+	entities.emplace_back(disabledEntity);
+	localWorld.postUpdate();
+	broadphase.update();
+	REQUIRE(std::size(broadphase) == 64);
+	REQUIRE(reportedPairs() == expectedPairs());
+}
+
+TEST_CASE("ComponentIndices look up Entities by Component fields", "[ComponentIndex]")
+{
+	secs::World localWorld;
+	localWorld.registerSystem<TeamSystem>();
+
+	std::vector<secs::Entity*> entities;
+	for (int i = 0; i < 12; ++i)
+	{
+		auto& entity = localWorld.createEntity<Team>();
+		entity.component<Team>().id = i % 4;
+		entities.emplace_back(&entity);
+	}
+	localWorld.postUpdate();
+
+	auto& hashIndex = localWorld.index<&Team::id>();
+	REQUIRE(&hashIndex == &localWorld.index<&Team::id>());
+	localWorld.postUpdate();
+	auto& orderedIndex = localWorld.index<&Team::id, secs::IndexKind::ordered>();
+
+	auto uidsOf = [](std::span<secs::Entity* const> found)
+	{
+		std::vector<secs::Uid> uids;
+		for (auto* entity : found)
+			uids.emplace_back(entity->uid());
+		std::ranges::sort(uids);
+		return uids;
+	};
+	REQUIRE(std::size(hashIndex) == 12);
+	REQUIRE(std::size(orderedIndex) == 12);
+	REQUIRE(uidsOf(hashIndex.find(1)) == std::vector{ entities[1]->uid(), entities[5]->uid(), entities[9]->uid() });
+	REQUIRE(hashIndex.count(4) == 0);
+	REQUIRE(std::empty(orderedIndex.find(4)));
+
+	// only keys of changed Components are refreshed
+	entities[1]->componentHandle<Team>()->id = 4;
+	entities[2]->setEnabled(false);
+	localWorld.destroyEntityLater(entities[3]->uid());
+	localWorld.postUpdate();
+	// Entities in teardown state are still indexed
+	REQUIRE(std::size(hashIndex) == 11);
+	REQUIRE(uidsOf(hashIndex.find(1)) == std::vector{ entities[5]->uid(), entities[9]->uid() });
+	REQUIRE(uidsOf(orderedIndex.find(4)) == std::vector{ entities[1]->uid() });
+	REQUIRE(hashIndex.count(2) == 2);
+	REQUIRE(hashIndex.count(3) == 3);
+
+	entities[2]->setEnabled(true);
+	localWorld.postUpdate();
+	REQUIRE(std::size(hashIndex) == 11);
+	REQUIRE(hashIndex.count(2) == 3);
+	REQUIRE(hashIndex.count(3) == 2);
+
+	std::vector<int> visitedKeys;
+	orderedIndex.forEachInRange(2, 4, [&](secs::Entity&, const int& key) { visitedKeys.emplace_back(key); });
+	REQUIRE(visitedKeys == std::vector{ 2, 2, 2, 3, 3, 4 });
+}